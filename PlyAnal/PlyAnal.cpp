@@ -1,5 +1,5 @@
 #include <thread>
-#include <chrono>
+#include <future>
 #include <vector>
 #include <sstream>
 #include <fstream>
@@ -20,53 +20,14 @@ using namespace tinyply;
 #include "Rendering.h"
 using namespace rendering;
 
-inline std::vector<uint8_t> read_file_binary(const std::string& pathToFile)
-{
-    std::ifstream file(pathToFile, std::ios::binary);
-    std::vector<uint8_t> fileBufferBytes;
-
-    if (file.is_open())
-    {
-        file.seekg(0, std::ios::end);
-        size_t sizeBytes = file.tellg();
-        file.seekg(0, std::ios::beg);
-        fileBufferBytes.resize(sizeBytes);
-        if (file.read((char*)fileBufferBytes.data(), sizeBytes)) return fileBufferBytes;
-    }
-    else throw std::runtime_error("could not open binary ifstream to path " + pathToFile);
-    return fileBufferBytes;
-}
-
-struct memory_buffer : public std::streambuf
-{
-    memory_buffer(char const* base, size_t size)
-    {
-        char* p(const_cast<char*>(base));
-        this->setg(p, p, p + size);
-    }
-};
-
-struct memory_stream : virtual memory_buffer, public std::istream
-{
-    memory_stream(char const* base, size_t size)
-        : memory_buffer(base, size), std::istream(static_cast<std::streambuf*>(this)) {}
-};
-
-class manual_timer
-{
-    std::chrono::high_resolution_clock::time_point t0;
-    double timestamp{ 0.f };
-public:
-    void start() { t0 = std::chrono::high_resolution_clock::now(); }
-    void stop() { timestamp = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - t0).count() * 1000; }
-    const double& get() { return timestamp; }
-};
-
 struct float2 { float x, y; };
 struct float3 { float x, y, z; };
 struct double3 { double x, y, z; };
 struct uint3 { uint32_t x, y, z; };
 struct uint4 { uint32_t x, y, z, w; };
+struct VertexPN { float3 position, normal; };
+
+namespace tinyply { template<> struct PlyLayout<VertexPN> : PlyRepeatedFields<float, 6> {}; }
 
 struct geometry
 {
@@ -145,24 +106,18 @@ void write_ply_example(const std::string& filename)
 // Tinyply treats parsed data as untyped byte buffers. See below for examples.
 std::shared_ptr<PlyData> vertices, normals, faces; // , texcoords;
 
-void read_ply_file(const std::string& filepath, const bool preload_into_memory = false)
+// With `metadata_only` set, only the header is read: element counts, properties and, for binary
+// files, where each element's records are, without touching the payload.
+void read_ply_file(const std::string& filepath, const bool memory_map = false, const bool metadata_only = false)
 {
     std::unique_ptr<std::istream> file_stream;
-    std::vector<uint8_t> byte_buffer;
 
     try
     {
-        // For most files < 1gb, pre-loading the entire file upfront and wrapping it into a 
-        // stream is a net win for parsing speed, about 40% faster. 
-        if (preload_into_memory)
-        {
-            byte_buffer = read_file_binary(filepath);
-            file_stream.reset(new memory_stream((char*)byte_buffer.data(), byte_buffer.size()));
-        }
-        else
-        {
-            file_stream.reset(new std::ifstream(filepath, std::ios::binary));
-        }
+        // The header is always parsed from a stream. With `memory_map` set, the payload is then
+        // read from a mapping of the file instead: no heap copy of the file is made, and whole
+        // list-free elements of little-endian files are handed back without any copy at all.
+        file_stream.reset(new std::ifstream(filepath, std::ios::binary));
 
         if (!file_stream || file_stream->fail()) throw std::runtime_error("failed to open " + filepath);
 
@@ -174,15 +129,22 @@ void read_ply_file(const std::string& filepath, const bool preload_into_memory =
         {
             std::cout << "Comment: " << c << std::endl;
         }
-        for (const auto& e : file.get_elements())
+        const tinyply::PlyIndex index = file.index();
+        const std::vector<tinyply::PlyElement> elements = file.get_elements();
+        for (size_t i = 0; i < elements.size(); ++i)
         {
-            std::cout << "element - " << e.name << " (" << e.size << ")" << std::endl;
+            const auto& e = elements[i];
+            const auto& extent = index.elements[i];
+            std::cout << "element - " << e.name << " (" << e.size << ")";
+            if (extent.located && extent.record_bytes) std::cout << " at bytes [" << extent.offset << ", " << extent.offset + extent.length << ")";
+            std::cout << std::endl;
             for (const auto& p : e.properties)
             {
                 std::cout << "\tproperty - " << p.name << " (" << tinyply::PropertyTable[p.propertyType].str << ")" << std::endl;
             }
         }
         std::cout << "........................................................................\n";
+        if (metadata_only) return;
 
         // The header information can be used to programmatically extract properties on elements
         // known to exist in the header prior to reading the data. For brevity of this sample, properties 
@@ -196,18 +158,22 @@ void read_ply_file(const std::string& filepath, const bool preload_into_memory =
         //try { texcoords = file.request_properties_from_element("vertex", { "u", "v" }); }
         //catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
 
-        // Providing a list size hint (the last argument) is a 2x performance improvement. If you have 
-        // arbitrary ply files, it is best to leave this 0. 
-        try { faces = file.request_properties_from_element("face", { "vertex_index" }, 3); }
+        // Faces are fan-triangulated as they are decoded, so meshes with quads or arbitrary
+        // polygons come back as a flat list of triangles.
+        try { faces = file.request_triangulated_faces("face", "vertex_index").triangles; }
         catch (const std::exception & e) { std::cerr << "tinyply exception: " << e.what() << std::endl; }
 
-        manual_timer read_timer;
-
-        read_timer.start();
-        file.read(*file_stream);
-        read_timer.stop();
+        if (memory_map) file.read_mapped(filepath);
+        else file.read(*file_stream);
 
-        //std::cout << "Reading took " << read_timer.get() / 1000.f << " seconds." << std::endl;
+        // Where the time went: the header, allocating the requests and decoding, per element
+        const PlyReadStats& stats = file.get_read_stats();
+        std::cout << "\tReading took " << stats.header_ms + stats.map_ms + stats.allocate_ms + stats.decode_ms + stats.finish_ms << " ms (header "
+            << stats.header_ms << ", allocation " << stats.allocate_ms << ", decoding " << stats.decode_ms << ")" << std::endl;
+        for (const auto& e : stats.elements)
+        {
+            if (e.requested) std::cout << "\t\t" << e.name << ": " << e.records << " records in " << e.decode_ms << " ms" << std::endl;
+        }
         if (vertices) std::cout << "\tRead " << vertices->count << " total vertices " << std::endl;
         if (normals) std::cout << "\tRead " << normals->count << " total vertex normals " << std::endl;
         //if (texcoords) std::cout << "\tRead " << texcoords->count << " total vertex texcoords " << std::endl;
@@ -244,7 +210,7 @@ int main(int argc, char* argv[]) try {
     const std::string filepath = "C:/Users/Kevin Bein/Desktop/Bone_binary_normals.ply";
     //const std::string filepath = "C:/Users/Kevin Bein/Desktop/simple.ply";
     
-    read_ply_file(filepath);
+    read_ply_file(filepath, true);
 
     std::unique_ptr<std::istream> file_stream;
     file_stream.reset(new std::ifstream(filepath, std::ios::binary));
@@ -256,26 +222,27 @@ int main(int argc, char* argv[]) try {
     plyf.parse_header(*file_stream);
     auto info = plyf.get_info();
 
-    auto vertices_ply = plyf.request_properties_from_element("vertex", { "x", "y", "z" });
-    auto normals_ply = plyf.request_properties_from_element("vertex", { "nx", "ny", "nz" });
-    auto faces_ply = plyf.request_properties_from_element("face", { "vertex_indices" }, 3);
+    // Positions and normals are decoded into interleaved floats, whatever precision the file uses
+    auto vertices_ply = plyf.request<VertexPN>("vertex", { "x", "y", "z", "nx", "ny", "nz" });
+    auto faces_ply = plyf.request_triangulated_faces("face", "vertex_indices").triangles;
+
+    // The file is read and decoded in the background while the window and shaders are set up
+    std::future<void> loaded = plyf.read_async(filepath);
+
+    auto rend = new Rendering(SCREEN_WIDTH, SCREEN_HEIGHT, "Ply Animator");
+    rend->printGLVersion();
 
-    plyf.read(*file_stream);
+    auto defaultProgram = rend->loadShader("shaders/vertices.vert", "shaders/vertices.frag");
 
-    const size_t numVerticesBytes = vertices_ply->buffer.size_bytes();
-    std::vector<float> vertices(vertices_ply->count * 3);
-    std::memcpy(vertices.data(), vertices_ply->buffer.get(), numVerticesBytes);
+    loaded.get();
 
-    const size_t numNormalsBytes = normals_ply->buffer.size_bytes();
-    std::vector<float> normals(normals_ply->count * 3);
-    std::memcpy(normals.data(), normals_ply->buffer.get(), numNormalsBytes);
+    const std::vector<VertexPN>& vertices = *vertices_ply;
 
     const size_t numFacesBytes = faces_ply->buffer.size_bytes();
-    std::vector<unsigned int> faces(faces_ply->count * 3);
+    std::vector<unsigned int> faces(faces_ply->count * 3); // three indices per triangle
     std::memcpy(faces.data(), faces_ply->buffer.get(), numFacesBytes);
 
-    std::cout << "vertices size: " << vertices_ply->buffer.size_bytes() << std::endl;
-    std::cout << "normals size: " << normals_ply->buffer.size_bytes() << std::endl;
+    std::cout << "vertices size: " << vertices.size() * sizeof(VertexPN) << std::endl;
     std::cout << "faces size: " << faces_ply->buffer.size_bytes() << std::endl;
 
     std::vector<float> faces_triangles(faces_ply->buffer.size_bytes());
@@ -284,28 +251,28 @@ int main(int argc, char* argv[]) try {
     int totalConnectedTriangles = 0;
     glm::vec3 min_vertex = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
     glm::vec3 max_vertex = { std::numeric_limits<float>::min(), std::numeric_limits<float>::min(), std::numeric_limits<float>::min() };
-    for (int i = 0; i < vertices_ply->count; ++i) {
-        min_vertex[0] = MIN(vertices[i * 3 + 0], min_vertex[0]);
-        min_vertex[1] = MIN(vertices[i * 3 + 1], min_vertex[1]);
-        min_vertex[2] = MIN(vertices[i * 3 + 2], min_vertex[2]);
-        max_vertex[0] = MAX(vertices[i * 3 + 0], max_vertex[0]);
-        max_vertex[1] = MAX(vertices[i * 3 + 1], max_vertex[1]);
-        max_vertex[2] = MAX(vertices[i * 3 + 2], max_vertex[2]);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        min_vertex[0] = MIN(vertices[i].position.x, min_vertex[0]);
+        min_vertex[1] = MIN(vertices[i].position.y, min_vertex[1]);
+        min_vertex[2] = MIN(vertices[i].position.z, min_vertex[2]);
+        max_vertex[0] = MAX(vertices[i].position.x, max_vertex[0]);
+        max_vertex[1] = MAX(vertices[i].position.y, max_vertex[1]);
+        max_vertex[2] = MAX(vertices[i].position.z, max_vertex[2]);
     }
     std::cout << "Min: (" << min_vertex[0] << "," << min_vertex[1] << "," << min_vertex[2] << ")" << std::endl;
     std::cout << "Max: (" << max_vertex[0] << "," << max_vertex[1] << "," << max_vertex[2] << ")" << std::endl;
     for (int i = 0; i < faces_ply->count; ++i) {
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 0] + 0]);
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 0] + 1]);
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 0] + 2]);
+        faces_triangles.push_back(vertices[faces[i * 3 + 0]].position.x);
+        faces_triangles.push_back(vertices[faces[i * 3 + 0]].position.y);
+        faces_triangles.push_back(vertices[faces[i * 3 + 0]].position.z);
 
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 1] + 0]);
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 1] + 1]);
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 1] + 2]);
+        faces_triangles.push_back(vertices[faces[i * 3 + 1]].position.x);
+        faces_triangles.push_back(vertices[faces[i * 3 + 1]].position.y);
+        faces_triangles.push_back(vertices[faces[i * 3 + 1]].position.z);
 
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 2] + 0]);
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 2] + 1]);
-        faces_triangles.push_back(vertices[3 * faces[i * 3 + 2] + 2]);
+        faces_triangles.push_back(vertices[faces[i * 3 + 2]].position.x);
+        faces_triangles.push_back(vertices[faces[i * 3 + 2]].position.y);
+        faces_triangles.push_back(vertices[faces[i * 3 + 2]].position.z);
 
         normal_index += 9;
         triangle_index += 9;
@@ -316,11 +283,6 @@ int main(int argc, char* argv[]) try {
     glm::vec3 verticesScaling = 1.0f / (max_vertex - min_vertex);
     std::cout << "Scaling to (-1.0, 1.0): (" << verticesScaling[0] << "," << verticesScaling[1] << "," << verticesScaling[2] << ")" << std::endl;
 
-    auto rend = new Rendering(SCREEN_WIDTH, SCREEN_HEIGHT, "Ply Animator");
-    rend->printGLVersion();
-
-    auto defaultProgram = rend->loadShader("shaders/vertices.vert", "shaders/vertices.frag");
-
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     //glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
@@ -335,12 +297,12 @@ int main(int argc, char* argv[]) try {
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(VertexPN), vertices.data(), GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, faces.size() * sizeof(float), faces.data(), GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexPN), (void*)0);
     glEnableVertexAttribArray(0);
 
     // note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
@@ -30,6 +30,9 @@
 #include <memory>
 #include <unordered_map>
 #include <map>
+#include <type_traits>
+#include <functional>
+#include <future>
 
 namespace tinyply
 {
@@ -74,13 +77,28 @@ namespace tinyply
         uint8_t* alias{ nullptr };
         struct delete_array { void operator()(uint8_t* p) { delete[] p; } };
         std::unique_ptr<uint8_t, decltype(Buffer::delete_array())> data;
+        std::shared_ptr<void> owner; // keeps aliased storage (e.g. a file mapping) alive
         size_t size{ 0 };
     public:
         Buffer() {};
         Buffer(const size_t size) : data(new uint8_t[size], delete_array()), size(size) { alias = data.get(); } // allocating
         Buffer(uint8_t* ptr) : alias(ptr) { } // non-allocating, todo: set size?
+        Buffer(uint8_t* ptr, const size_t size, std::shared_ptr<void> owner) : alias(ptr), owner(owner), size(size) { } // non-allocating, shared lifetime
         uint8_t* get() { return alias; }
+        const uint8_t* get() const { return alias; }
         size_t size_bytes() const { return size; }
+        void shrink_to(const size_t bytes) { if (bytes < size) size = bytes; } // storage is kept
+    };
+
+    /*
+     * How a group of requested properties is laid out in its buffer. Interleaved holds one record
+     * after the other (x y z x y z ...); Columns holds each property in a column of its own
+     * (x x ... y y ... z z ...), every column starting on a 64 byte boundary.
+     */
+    enum class Layout : uint8_t
+    {
+        Interleaved,
+        Columns
     };
 
     struct PlyData
@@ -89,6 +107,7 @@ namespace tinyply
         Buffer buffer;
         size_t count{ 0 };
         bool isList{ false };
+        size_t columnStride{ 0 }; // Layout::Columns: bytes from the start of one column to the next, otherwise 0
     };
 
     struct PlyProperty
@@ -113,6 +132,233 @@ namespace tinyply
         std::vector<PlyProperty> properties;
     };
 
+    /*
+     * Where the records of an element are in a file, computed by `PlyFile::index()` from the
+     * header alone. Offsets are in bytes from the start of the header. Binary elements with list
+     * properties have no fixed record size, so neither their length nor the offset of any element
+     * after them is known; ascii payloads have neither.
+     */
+    struct PlyElementIndex
+    {
+        std::string name;
+        size_t count{ 0 };
+        size_t record_bytes{ 0 }; // 0 unless the records have a fixed size
+        bool located{ false };    // `offset` is known; so is `length` when `record_bytes` is set
+        uint64_t offset{ 0 };
+        uint64_t length{ 0 };
+    };
+
+    struct PlyIndex
+    {
+        bool binary{ false };
+        bool big_endian{ false };
+        uint64_t header_bytes{ 0 }; // the payload starts right after the `end_header` line
+        std::vector<PlyElementIndex> elements;
+    };
+
+    /*
+     * Source of the storage behind the buffers that `read` allocates for requested data. Without
+     * one, each buffer is allocated with new[]. An allocator returns buffers that own their storage
+     * (see the `owner` constructor of `Buffer`), and may be called from several threads at once.
+     */
+    struct PlyAllocator
+    {
+        virtual ~PlyAllocator() {}
+        virtual Buffer allocate(const size_t bytes) = 0;
+    };
+
+    struct PlyBufferPoolStats
+    {
+        size_t heap_allocations{ 0 }; // blocks obtained with new[]
+        size_t reuses{ 0 };           // allocations served from a released block
+        size_t releases{ 0 };         // blocks given back by the last buffer using them
+        size_t bytes_allocated{ 0 };  // total size of the blocks obtained with new[]
+        size_t bytes_cached{ 0 };     // released blocks currently held for reuse
+    };
+
+    /*
+     * An allocator that keeps the blocks of released buffers and hands them out again, so that
+     * loading a sequence of similar frames settles into a steady state where decoded data needs
+     * no heap allocations: once frame N's PlyData is dropped, frame N + 1 reuses its blocks.
+     * Blocks are rounded up to |granularity|, and an allocation takes the smallest released block
+     * that fits and is at most twice its size. Up to |max_cached_bytes| of released blocks are
+     * kept; beyond that they are freed. Buffers may outlive the pool.
+     */
+    class PlyBufferPool : public PlyAllocator
+    {
+        struct State;
+        std::shared_ptr<State> state;
+    public:
+        PlyBufferPool(const size_t max_cached_bytes = size_t(1) << 30, const size_t granularity = 64 * 1024);
+        Buffer allocate(const size_t bytes) override;
+        PlyBufferPoolStats stats() const;
+        void trim(); // frees the cached blocks
+    };
+
+    /*
+     * Decoder selection for `read(...)`. The defaults pick the fastest available path; the
+     * alternatives produce identical `PlyData` and are kept for validation and benchmarking.
+     */
+    struct PlyReadOptions
+    {
+        // Binary elements without list properties have a fixed record stride, so they can be
+        // read in large blocks and the requested properties scattered with strided copies.
+        // When false, every property of every record is decoded with its own stream read.
+        bool bulk_binary{ true };
+
+        // Ascii payloads are tokenized in place over a buffer and converted without iostreams.
+        // When false, every value is extracted with `std::istream::operator>>`.
+        bool fast_ascii{ true };
+
+        // Worker threads for ascii payloads with one record per line (0 selects the number of
+        // hardware threads). With more than one, a newline index of the payload is built and each
+        // element's lines are split across threads; streamed input is first read into memory.
+        unsigned int num_threads{ 1 };
+
+        // Upper bound on the size of the blocks read by the bulk decoders.
+        size_t block_size_bytes{ 256 * 1024 };
+
+        // `read_async` reads the file ahead on an I/O thread into a ring of this many buffers
+        // of this size, which the decoder consumes as they fill.
+        unsigned int async_buffers{ 4 };
+        size_t async_buffer_bytes{ 4 * 1024 * 1024 };
+
+        // Storage for the requested data (e.g. a shared `PlyBufferPool`); new[] when null.
+        std::shared_ptr<PlyAllocator> allocator;
+    };
+
+    struct PlyElementReadStats
+    {
+        std::string name;
+        size_t records{ 0 };
+        bool requested{ false }; // false when the element was stepped over, or not read at all
+        double decode_ms{ 0 };
+    };
+
+    /*
+     * What the last `parse_header` and load (`read`, `read_mapped` or `read_async`) of a PlyFile
+     * did, from `PlyFile::get_read_stats()`. Stats are always collected: timing takes a clock
+     * reading per phase and per element, and counters are kept per block or per value read,
+     * never per byte. Big endian values are swapped while they are decoded, so swapping is part
+     * of `decode_ms`. The iostream ascii decoder (`fast_ascii` off) doesn't count bytes.
+     */
+    struct PlyReadStats
+    {
+        double header_ms{ 0 };   // parsing the header, or comparing it with a schema
+        double map_ms{ 0 };      // `read_mapped`: mapping the file and aliasing whole elements
+        double allocate_ms{ 0 }; // sizing and allocating the buffers of the requests
+        double decode_ms{ 0 };   // the pass over the payload
+        double finish_ms{ 0 };   // last batches, spilled lists joined, structs scattered
+        size_t header_bytes{ 0 };
+        size_t bytes_read{ 0 };      // payload bytes read from the stream or copied from the mapping
+        size_t bytes_skipped{ 0 };   // payload bytes stepped over without being read: unrequested, or aliased by `read_mapped`
+        size_t read_calls{ 0 };      // stream reads issued by the decoders
+        size_t records_decoded{ 0 }; // records of requested elements, other than those aliased by `read_mapped`
+        size_t allocations{ 0 };     // buffers allocated for requested data, including spilled list chunks
+        size_t bytes_allocated{ 0 };
+        std::vector<PlyElementReadStats> elements; // in header order
+    };
+
+    /*
+     * Faces requested with `request_triangulated_faces(...)`, filled in by `read`.
+     */
+    struct PlyTriangulatedFaces
+    {
+        std::shared_ptr<PlyData> triangles;       // Type::UINT32, three indices per triangle; `count` is the number of triangles
+        std::shared_ptr<PlyData> polygon_offsets; // Type::UINT32, `count` = polygons + 1; null unless requested
+    };
+
+    /*
+     * A 3D Gaussian splat capture requested with `request_gaussian_splats(...)`: one Type::FLOAT32
+     * array per attribute, each starting on a 64 byte boundary, filled in by `read`. The `count`
+     * of every array is the number of splats.
+     */
+    struct PlyGaussianSplats
+    {
+        size_t count{ 0 };     // splats
+        size_t sh_degree{ 0 }; // 0 to 3; each color channel has (sh_degree + 1)^2 coefficients
+        std::shared_ptr<PlyData> positions; // x, y, z
+        std::shared_ptr<PlyData> scales;    // scale_0..2
+        std::shared_ptr<PlyData> rotations; // rot_0..3, a quaternion with w first
+        std::shared_ptr<PlyData> opacities; // opacity
+        std::shared_ptr<PlyData> sh;        // f_dc_0..2, then f_rest_* in file order (channel-major)
+    };
+
+    /*
+     * Compile-time layout of the structs filled by `PlyFile::request<T>(...)`: the types of their
+     * fields in declaration order, one per requested property. An arithmetic type is a single field;
+     * other structs are described by specializing `PlyLayout`, e.g.
+     *
+     *     struct VertexPN { float x, y, z, nx, ny, nz; };
+     *     struct VertexC { float x, y, z; uint8_t r, g, b; };
+     *     namespace tinyply {
+     *         template<> struct PlyLayout<VertexPN> : PlyRepeatedFields<float, 6> {};
+     *         template<> struct PlyLayout<VertexC> : PlyFields<float, float, float, uint8_t, uint8_t, uint8_t> {};
+     *     }
+     *
+     * Field offsets follow the usual alignment rules; `request<T>` checks that they add up to sizeof(T).
+     */
+    template<typename T> struct PlyTypeOf { static const Type value = Type::INVALID; };
+    template<> struct PlyTypeOf<int8_t> { static const Type value = Type::INT8; };
+    template<> struct PlyTypeOf<uint8_t> { static const Type value = Type::UINT8; };
+    template<> struct PlyTypeOf<int16_t> { static const Type value = Type::INT16; };
+    template<> struct PlyTypeOf<uint16_t> { static const Type value = Type::UINT16; };
+    template<> struct PlyTypeOf<int32_t> { static const Type value = Type::INT32; };
+    template<> struct PlyTypeOf<uint32_t> { static const Type value = Type::UINT32; };
+    template<> struct PlyTypeOf<float> { static const Type value = Type::FLOAT32; };
+    template<> struct PlyTypeOf<double> { static const Type value = Type::FLOAT64; };
+
+    namespace detail
+    {
+        constexpr size_t ply_align(size_t offset, size_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+
+        // Walks the fields, placing each at the next offset aligned for its type
+        template<size_t Offset, size_t Alignment, typename... Fields> struct ply_fields_from
+        {
+            static const bool valid = true;
+            static const size_t size = ply_align(Offset, Alignment);
+            static void describe(Type*, size_t*) {}
+        };
+
+        template<size_t Offset, size_t Alignment, typename F, typename... Rest> struct ply_fields_from<Offset, Alignment, F, Rest...>
+        {
+            static const size_t offset = ply_align(Offset, alignof(F));
+            typedef ply_fields_from<offset + sizeof(F), (alignof(F) > Alignment ? alignof(F) : Alignment), Rest...> next;
+            static const bool valid = PlyTypeOf<F>::value != Type::INVALID && next::valid;
+            static const size_t size = next::size;
+            static void describe(Type* types, size_t* offsets) { *types = PlyTypeOf<F>::value; *offsets = offset; next::describe(types + 1, offsets + 1); }
+        };
+    }
+
+    template<typename... Fields> struct PlyFields : detail::ply_fields_from<0, 1, Fields...>
+    {
+        static const size_t count = sizeof...(Fields);
+    };
+
+    template<typename T, size_t N, typename... Fields> struct PlyRepeatedFields : PlyRepeatedFields<T, N - 1, T, Fields...> {};
+    template<typename T, typename... Fields> struct PlyRepeatedFields<T, 0, Fields...> : PlyFields<Fields...> {};
+
+    template<typename T> struct PlyLayout : PlyFields<T> {};
+
+    struct PlyFile;
+
+    /*
+     * The header and requests of a file, kept so that files with the same header, such as the
+     * frames of a sequence, can skip parsing it and making the requests again. Made from a PlyFile
+     * whose header is parsed and whose requests are made; see `PlyFile::parse_header(is, schema)`.
+     * Struct and batch requests can't be kept. A schema may be shared between threads.
+     */
+    class PlySchema
+    {
+        friend struct PlyFile;
+        struct State;
+        std::shared_ptr<const State> state;
+    public:
+        PlySchema() {}
+        explicit PlySchema(const PlyFile& file);
+        bool empty() const { return !state; }
+    };
+
     struct PlyFile
     {
         struct PlyFileImpl;
@@ -129,11 +375,50 @@ namespace tinyply
          */
         bool parse_header(std::istream& is);
 
+        /*
+         * Reads the header, and if it is byte for byte the one |schema| was made from, sets this
+         * file up with the schema's header and requests, ready to `read`; the new PlyData are
+         * returned by `get_requests()`. Otherwise (always for an empty schema) returns false, with
+         * |is| put back where it was so that the header can be parsed as usual. That requires a
+         * seekable stream.
+         */
+        bool parse_header(std::istream& is, const PlySchema& schema);
+
+        /*
+         * The PlyData of each request in the order they were made. Triangulated faces add their
+         * triangles, followed by the polygon offsets if those were requested.
+         */
+        std::vector<std::shared_ptr<PlyData>> get_requests() const;
+
+        /*
+         * Timing and counters of the last `parse_header` and load, once it is done.
+         */
+        const PlyReadStats& get_read_stats() const;
+
         /*
          * Execute a read operation. Data must be requested via `request_properties_from_element(...)`
          * prior to calling this function.
          */
-        void read(std::istream& is);
+        void read(std::istream& is, const PlyReadOptions& options = PlyReadOptions());
+
+        /*
+         * Same as `read(...)`, but the payload is memory-mapped from `path` instead of being
+         * streamed. The header must already have been parsed from the same file. For binary
+         * little-endian files, a property group that covers every property of a list-free
+         * element is not copied at all: its `PlyData::buffer` aliases the mapping (copy-on-write),
+         * which stays alive for as long as any such buffer does. All other groups are decoded
+         * directly from the mapped memory.
+         */
+        void read_mapped(const std::string& path, const PlyReadOptions& options = PlyReadOptions());
+
+        /*
+         * Same as `read(...)`, but runs on a background thread and returns at once. The payload is
+         * read from `path` (whose header must already have been parsed) by a dedicated I/O thread
+         * while the data is decoded, so that reading the disk overlaps with parsing. The future
+         * becomes ready, or holds the exception, when the read is done; requests and this PlyFile
+         * must not be touched until then.
+         */
+        std::future<void> read_async(const std::string& path, const PlyReadOptions& options = PlyReadOptions());
 
         /*
          * `write` performs no validation and assumes that the data passed into
@@ -150,14 +435,108 @@ namespace tinyply
         std::vector<std::string>& get_comments();
 
         /*
-         * In the general case where |list_size_hint| is zero, `read` performs a two-pass
-         * parse to support variable length lists. The most general use of the
-         * ply format is storing triangle meshes. When this fact is known a-priori, we can pass
-         * an expected list length that will apply to this element. Doing so results in an up-front
-         * memory allocation and a single-pass import, a 2x performance optimization.
+         * The byte range of each element in the file, worked out from the header without
+         * touching the payload. Valid after `parse_header(...)`.
+         */
+        PlyIndex index() const;
+
+        /*
+         * Reads records [first, first + count) of a list-free element of a binary file straight from
+         * |path|, at the offset given by `index()`: only those records are read from disk. The
+         * properties come back packed as from `request_properties_from_element`, converted to
+         * |type| if it is set. This is independent of requests and `read`, and may be called from
+         * several threads at once on the same PlyFile once the header is parsed.
+         */
+        std::shared_ptr<PlyData> read_range(const std::string& path, const std::string& elementKey,
+            const std::initializer_list<std::string> propertyKeys, const size_t first, const size_t count,
+            const Type type = Type::INVALID);
+
+        /*
+         * `read` decodes variable length lists in a single pass. Buffers are allocated up front
+         * assuming every list holds |list_size_hint| values (3 when zero, as in triangle meshes);
+         * a group whose lists turn out longer keeps growing while it is decoded and is joined into
+         * one contiguous buffer at the end. The hint only saves that copy when it is accurate:
+         * files with mixed list lengths are decoded correctly with any hint.
+         *
+         * With a |type| other than Type::INVALID, values are converted to that type (as by
+         * `static_cast`) while they are decoded, and the buffer holds the converted layout.
+         *
+         * With Layout::Columns, property i of record r is at `buffer.get() + i * columnStride +
+         * r * width`, for SIMD passes over separate x[], y[], z[] arrays. The properties must not be
+         * lists and must share a width once converted to |type|. Binary elements are decoded
+         * straight into the columns (read with `bulk_binary`); other payloads are decoded
+         * interleaved and transposed once read.
          */
         std::shared_ptr<PlyData> request_properties_from_element(const std::string& elementKey,
-            const std::initializer_list<std::string> propertyKeys, const uint32_t list_size_hint = 0);
+            const std::initializer_list<std::string> propertyKeys, const uint32_t list_size_hint = 0,
+            const Type type = Type::INVALID, const Layout layout = Layout::Interleaved);
+
+        /*
+         * Streams properties instead of holding them for the whole element: during `read`, |callback|
+         * receives the properties of |batch_size| records at a time (fewer for the last batch),
+         * laid out as for `request_properties_from_element`, along with the index of the first
+         * record. The batch buffer is reused for every batch, so memory does not grow with the
+         * element. Ascii payloads are then decoded on one thread, as the parallel decoder needs
+         * the whole payload in memory.
+         */
+        void request_batches(const std::string& elementKey, const std::initializer_list<std::string> propertyKeys,
+            const size_t batch_size, std::function<void(const PlyData& batch, size_t first)> callback,
+            const uint32_t list_size_hint = 0, const Type type = Type::INVALID);
+
+        /*
+         * Requests a list of vertex indices (e.g. "face" / "vertex_indices") as triangles. Each
+         * polygon is fan-triangulated while it is decoded ({v0, v1, v2}, {v0, v2, v3}, ...), so
+         * quads and n-gons load straight into an element buffer; polygons with fewer than three
+         * indices are dropped. With |polygon_offsets| set, polygon i produced the triangles
+         * [offsets[i], offsets[i + 1]), which maps per-face data onto the triangles.
+         */
+        PlyTriangulatedFaces request_triangulated_faces(const std::string& elementKey,
+            const std::string& propertyKey, const bool polygon_offsets = false);
+
+        /*
+         * Requests the splats of a 3D Gaussian splat capture: x, y, z, scale_0..2, rot_0..3,
+         * opacity, f_dc_0..2 and 0, 9, 24 or 45 f_rest_* properties on |elementKey| (others, such
+         * as normals, are skipped). The whole schema is decoded as one group, a batch of records
+         * at a time, and each batch is scattered into the arrays of `PlyGaussianSplats` while it
+         * is still in cache. With |activate| set, opacities go through a sigmoid, scales through
+         * exp, and rotations are normalized on the way, as renderers expect them.
+         */
+        PlyGaussianSplats request_gaussian_splats(const std::string& elementKey = "vertex", const bool activate = false);
+
+        /*
+         * Requests properties of a list-free element as an array of structs, one property per field
+         * of `PlyLayout<T>`. Values are converted to the field types while they are decoded. Binary
+         * elements are decoded straight into the vector (read with `bulk_binary`); other payloads
+         * are decoded as for `request_properties_from_element` and copied into it once read.
+         * The vector is sized when requested and filled in by `read`.
+         */
+        template<typename T> std::shared_ptr<std::vector<T>> request(const std::string& elementKey,
+            const std::initializer_list<std::string> propertyKeys)
+        {
+            typedef PlyLayout<T> layout;
+            static_assert(layout::valid, "PlyLayout<T> fields must be the arithmetic types of ply properties");
+            static_assert(layout::size == sizeof(T), "PlyLayout<T> does not describe the fields of T");
+            static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+            Type types[layout::count];
+            size_t offsets[layout::count];
+            layout::describe(types, offsets);
+
+            std::shared_ptr<std::vector<T>> values = std::make_shared<std::vector<T>>();
+            request_struct(elementKey, propertyKeys, types, offsets, layout::count, sizeof(T), values,
+                [](void* storage, size_t count) -> uint8_t*
+                {
+                    std::vector<T>& v = *static_cast<std::vector<T>*>(storage);
+                    v.resize(count);
+                    return reinterpret_cast<uint8_t*>(v.data());
+                });
+            return values;
+        }
+
+        // Registers a struct request for `request<T>`; |resize| sizes |storage| to the element
+        void request_struct(const std::string& elementKey, const std::initializer_list<std::string> propertyKeys,
+            const Type* types, const size_t* offsets, const size_t numFields, const size_t stride,
+            std::shared_ptr<void> storage, uint8_t* (*resize)(void* storage, size_t count));
 
         void add_properties_to_element(const std::string& elementKey,
             const std::initializer_list<std::string> propertyKeys,
@@ -168,6 +547,19 @@ namespace tinyply
             const size_t listCount);
     };
 
+    /*
+     * Loads many files at once, e.g. the frames of a sequence. |num_threads| workers (0 selects
+     * the number of hardware threads) each read whole files into memory with positioned reads and
+     * decode them there. For every file, |request| is called on the worker once its header is
+     * parsed, with the index of the path and the PlyFile to make requests on; the data is read
+     * right after it returns. |request| runs concurrently for different files. If any file fails,
+     * the remaining ones are still loaded and the first error is then thrown, naming its file.
+     */
+    void read_ply_files(const std::vector<std::string>& paths,
+        std::function<void(size_t index, PlyFile& file)> request,
+        const unsigned int num_threads = 0,
+        const PlyReadOptions& options = PlyReadOptions());
+
 } // end namespace tinyply
 
 #endif // end tinyply_h
@@ -183,6 +575,44 @@ namespace tinyply
 #include <type_traits>
 #include <iostream>
 #include <cstring>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cfloat>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+// SIMD kernels are selected at compile time (e.g. -mavx2 or /arch:AVX2); scalar code is always available
+#if defined(__AVX2__)
+    #define TINYPLY_AVX2 1
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+    #define TINYPLY_SSSE3 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TINYPLY_SSE2 1
+#endif
+#if defined(TINYPLY_AVX2) || defined(TINYPLY_SSE2)
+    #include <immintrin.h>
+#endif
 
 using namespace tinyply;
 using namespace std;
@@ -207,15 +637,6 @@ template<> inline int64_t endian_swap<int64_t, int64_t>(const int64_t& v) { uint
 template<> inline float endian_swap<uint32_t, float>(const uint32_t& v) { union { float f; uint32_t i; }; i = endian_swap<uint32_t, uint32_t>(v); return f; }
 template<> inline double endian_swap<uint64_t, double>(const uint64_t& v) { union { double d; uint64_t i; }; i = endian_swap<uint64_t, uint64_t>(v); return d; }
 
-inline uint32_t hash_fnv1a(const std::string& str)
-{
-    static const uint32_t fnv1aBase32 = 0x811C9DC5u;
-    static const uint32_t fnv1aPrime32 = 0x01000193u;
-    uint32_t result = fnv1aBase32;
-    for (auto& c : str) { result ^= static_cast<uint32_t>(c); result *= fnv1aPrime32; }
-    return result;
-}
-
 inline Type property_type_from_string(const std::string& t)
 {
     if (t == "int8" || t == "char")           return Type::INT8;
@@ -231,649 +652,3229 @@ inline Type property_type_from_string(const std::string& t)
 
 typedef std::function<void(void* dest, const char* src, bool be)> cast_t;
 
-struct PlyFile::PlyFileImpl
+// Read-only view of a whole file. Pages are mapped copy-on-write so that buffers aliasing
+// the mapping can still be modified in-place by the caller without touching the file.
+class PlyMappedFile
 {
-    struct PlyDataCursor
+    uint8_t* base{ nullptr };
+    size_t length{ 0 };
+#if defined(_WIN32)
+    HANDLE file{ INVALID_HANDLE_VALUE };
+    HANDLE mapping{ nullptr };
+#endif
+public:
+    PlyMappedFile(const std::string& path)
     {
-        size_t byteOffset{ 0 };
-        size_t totalSizeBytes{ 0 };
-    };
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("could not open file for mapping: " + path);
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { CloseHandle(file); throw std::runtime_error("could not map empty file: " + path); }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (mapping) base = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+        if (!base)
+        {
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file);
+            throw std::runtime_error("could not map file: " + path);
+        }
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("could not open file for mapping: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); throw std::runtime_error("could not map empty file: " + path); }
+        length = static_cast<size_t>(st.st_size);
+        void* ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping holds its own reference to the file
+        if (ptr == MAP_FAILED) throw std::runtime_error("could not map file: " + path);
+        ::madvise(ptr, length, MADV_SEQUENTIAL);
+        base = static_cast<uint8_t*>(ptr);
+#endif
+    }
 
-    struct ParsingHelper
+    ~PlyMappedFile()
     {
-        std::shared_ptr<PlyData> data;
-        std::shared_ptr<PlyDataCursor> cursor;
-        uint32_t list_size_hint;
-    };
+#if defined(_WIN32)
+        UnmapViewOfFile(base);
+        CloseHandle(mapping);
+        CloseHandle(file);
+#else
+        ::munmap(base, length);
+#endif
+    }
 
-    struct PropertyLookup
-    {
-        ParsingHelper* helper{ nullptr };
-        bool skip{ false };
-        size_t prop_stride{ 0 }; // precomputed
-        size_t list_stride{ 0 }; // precomputed
-    };
+    PlyMappedFile(const PlyMappedFile&) = delete;
+    PlyMappedFile& operator=(const PlyMappedFile&) = delete;
 
-    std::unordered_map<uint32_t, ParsingHelper> userData;
+    uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+};
 
-    bool isBinary = false;
-    bool isBigEndian = false;
-    std::vector<PlyElement> elements;
-    std::vector<std::string> comments;
-    std::vector<std::string> objInfo;
-    uint8_t scratch[64]; // large enough for max list size
+// A file read at explicit offsets (pread / ReadFile with an offset), so that one handle can serve
+// reads from several threads without a shared file position
+class PlyRandomAccessFile
+{
+#if defined(_WIN32)
+    HANDLE file{ INVALID_HANDLE_VALUE };
+#else
+    int fd{ -1 };
+#endif
+public:
+    PlyRandomAccessFile(const std::string& path)
+    {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("could not open file: " + path);
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("could not open file: " + path);
+#endif
+    }
 
-    void read(std::istream& is);
-    void write(std::ostream& os, bool isBinary);
+    uint64_t size() const
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) throw std::runtime_error("could not stat file");
+        return uint64_t(fileSize.QuadPart);
+#else
+        struct stat st;
+        if (::fstat(fd, &st) != 0) throw std::runtime_error("could not stat file");
+        return uint64_t(st.st_size);
+#endif
+    }
 
-    std::shared_ptr<PlyData> request_properties_from_element(const std::string& elementKey,
-        const std::initializer_list<std::string> propertyKeys,
-        const uint32_t list_size_hint);
+    ~PlyRandomAccessFile()
+    {
+#if defined(_WIN32)
+        CloseHandle(file);
+#else
+        ::close(fd);
+#endif
+    }
 
-    void add_properties_to_element(const std::string& elementKey,
-        const std::initializer_list<std::string> propertyKeys,
-        const Type type, const size_t count, uint8_t* data, const Type listType, const size_t listCount);
+    PlyRandomAccessFile(const PlyRandomAccessFile&) = delete;
+    PlyRandomAccessFile& operator=(const PlyRandomAccessFile&) = delete;
 
-    size_t read_property_binary(const Type& t, const size_t& stride, void* dest, size_t& destOffset, std::istream& is);
-    size_t read_property_ascii(const Type& t, const size_t& stride, void* dest, size_t& destOffset, std::istream& is);
+    // Reads up to |bytes| at |offset|, stopping early only at the end of the file
+    size_t read_some(uint8_t* dst, size_t bytes, uint64_t offset) const
+    {
+        size_t total = 0;
+        while (bytes > 0)
+        {
+#if defined(_WIN32)
+            OVERLAPPED at = {};
+            at.Offset = static_cast<DWORD>(offset);
+            at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD got = 0;
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes, 1u << 30));
+            if (!ReadFile(file, dst, chunk, &got, &at))
+            {
+                if (GetLastError() == ERROR_HANDLE_EOF) break;
+                throw std::runtime_error("failed to read file");
+            }
+#else
+            const ssize_t got = ::pread(fd, dst, std::min<size_t>(bytes, 1u << 30), static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) throw std::runtime_error("failed to read file");
+#endif
+            if (got == 0) break;
+            dst += got;
+            bytes -= size_t(got);
+            offset += uint64_t(got);
+            total += size_t(got);
+        }
+        return total;
+    }
 
-    std::vector<std::vector<PropertyLookup>> make_property_lookup_table()
+    // Reads exactly |bytes| at |offset|; a short file is an error
+    void read(uint8_t* dst, size_t bytes, uint64_t offset) const
     {
-        std::vector<std::vector<PropertyLookup>> element_property_lookup;
+        if (read_some(dst, bytes, offset) != bytes) throw std::runtime_error("unexpected end of file");
+    }
+};
 
-        for (auto& element : elements)
-        {
-            std::vector<PropertyLookup> lookups;
+// Reads a file sequentially from |offset| on its own thread, into a ring of page-aligned buffers
+// that are handed to the stream one at a time as they fill. The reader only waits when it has
+// caught up with the disk, and the I/O thread only when every buffer is still unread.
+class prefetch_streambuf : public std::streambuf
+{
+    struct Slot
+    {
+        std::unique_ptr<uint8_t[]> storage;
+        uint8_t* data;
+        size_t size;
+    };
 
-            for (auto& property : element.properties)
+    PlyRandomAccessFile file;
+    std::vector<Slot> ring;
+    size_t bufferBytes;
+    size_t head{ 0 }; // next slot to hand to the stream
+    size_t ready{ 0 }; // filled slots, including the one the stream is reading
+    bool reading{ false }; // the stream holds ring[head]
+    bool done{ false };
+    bool stop{ false };
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread io;
+
+    void fill(uint64_t offset)
+    {
+        size_t tail = 0;
+        try
+        {
+            for (;;)
             {
-                PropertyLookup f;
-
-                auto cursorIt = userData.find(hash_fnv1a(element.name + property.name));
-                if (cursorIt != userData.end()) f.helper = &cursorIt->second;
-                else f.skip = true;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [&]() { return stop || ready < ring.size(); });
+                    if (stop) return;
+                }
 
-                f.prop_stride = PropertyTable[property.propertyType].stride;
-                if (property.isList) f.list_stride = PropertyTable[property.listType].stride;
+                // ring[tail] is not visible to the stream until it is counted as ready
+                Slot& slot = ring[tail];
+                slot.size = file.read_some(slot.data, bufferBytes, offset);
+                offset += slot.size;
 
-                lookups.push_back(f);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (slot.size == 0) { done = true; cv.notify_all(); return; }
+                ++ready;
+                tail = (tail + 1) % ring.size();
+                cv.notify_all();
             }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            done = true;
+            cv.notify_all();
+        }
+    }
 
-            element_property_lookup.push_back(lookups);
+public:
+    prefetch_streambuf(const std::string& path, uint64_t offset, size_t bufferBytes, size_t numBuffers) : file(path), ring(numBuffers), bufferBytes(bufferBytes)
+    {
+        const size_t alignment = 4096;
+        for (auto& slot : ring)
+        {
+            slot.storage.reset(new uint8_t[bufferBytes + alignment]);
+            slot.data = reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(slot.storage.get()) + alignment - 1) & ~uintptr_t(alignment - 1));
+            slot.size = 0;
         }
+        io = std::thread(&prefetch_streambuf::fill, this, offset);
+    }
 
-        return element_property_lookup;
+    ~prefetch_streambuf()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cv.notify_all();
+        io.join();
     }
 
-    bool parse_header(std::istream& is);
-    void parse_data(std::istream& is, bool firstPass);
-    void read_header_format(std::istream& is);
-    void read_header_element(std::istream& is);
-    void read_header_property(std::istream& is);
-    void read_header_text(std::string line, std::istream& is, std::vector<std::string>& place, int erase = 0);
+    // The error that ended reading early, if any; the stream itself only sees the end of the file
+    std::exception_ptr io_error()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return error;
+    }
 
-    void write_header(std::ostream& os);
-    void write_ascii_internal(std::ostream& os);
-    void write_binary_internal(std::ostream& os);
-    void write_property_ascii(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset);
-    void write_property_binary(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset, const size_t& stride);
+protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (reading)
+        {
+            // Give the slot just consumed back to the I/O thread
+            head = (head + 1) % ring.size();
+            --ready;
+            reading = false;
+            cv.notify_all();
+        }
+        cv.wait(lock, [&]() { return ready > 0 || done; });
+        if (ready == 0) return traits_type::eof();
+
+        reading = true;
+        char* p = reinterpret_cast<char*>(ring[head].data);
+        this->setg(p, p, p + ring[head].size);
+        return traits_type::to_int_type(*gptr());
+    }
 };
 
-PlyProperty::PlyProperty(std::istream& is) : isList(false)
+// Seekable istream over a block of memory. Used to run the regular parser over a mapping.
+struct memory_streambuf : public std::streambuf
 {
-    std::string type;
-    is >> type;
-    if (type == "list")
+    memory_streambuf(const uint8_t* base, size_t size)
     {
-        std::string countType;
-        is >> countType >> type;
-        listType = property_type_from_string(countType);
-        isList = true;
+        char* p = reinterpret_cast<char*>(const_cast<uint8_t*>(base));
+        this->setg(p, p, p + size);
     }
-    propertyType = property_type_from_string(type);
-    is >> name;
-}
-
-PlyElement::PlyElement(std::istream& is)
-{
-    is >> name >> size;
-}
 
-template<typename T> inline T ply_read_ascii(std::istream& is)
-{
-    T data;
-    is >> data;
-    return data;
-}
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) override
+    {
+        char* target = (dir == std::ios_base::beg) ? eback() + off : (dir == std::ios_base::cur) ? gptr() + off : egptr() + off;
+        if (!(which & std::ios_base::in) || target < eback() || target > egptr()) return pos_type(off_type(-1));
+        this->setg(eback(), target, egptr());
+        return pos_type(target - eback());
+    }
 
-template<typename T, typename T2>
-inline void endian_swap_buffer(uint8_t* data_ptr, const size_t num_bytes, const size_t stride)
-{
-    for (size_t count = 0; count < num_bytes; count += stride)
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override
     {
-        *(reinterpret_cast<T2*>(data_ptr)) = endian_swap<T, T2>(*(reinterpret_cast<const T*>(data_ptr)));
-        data_ptr += stride;
+        return seekoff(off_type(pos), std::ios_base::beg, which);
     }
-}
 
-template<typename T> void ply_cast_ascii(void* dest, std::istream& is)
+    // Direct access for decoders that can consume the memory without a copy
+    const uint8_t* cursor() const { return reinterpret_cast<const uint8_t*>(gptr()); }
+    size_t remaining() const { return size_t(egptr() - gptr()); }
+    void advance(size_t n) { this->setg(eback(), gptr() + n, egptr()); }
+};
+
+// Deinterleave kernels: copy a `bytes`-wide field found at the same offset in each of `count`
+// records of `srcStride` bytes into a destination with `dstStride` bytes per record. `src` and `dst`
+// already point at the field within the first record. The bulk binary decoder picks one kernel per
+// copy span before running over the blocks, so the inner loop has no per-record dispatch.
+typedef void(*deinterleave_fn)(uint8_t* dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t count);
+
+// Generic fallback: field width known only at runtime
+inline void deinterleave_any(uint8_t* dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t count, size_t bytes)
 {
-    *(static_cast<T*>(dest)) = ply_read_ascii<T>(is);
+    for (size_t r = 0; r < count; ++r, dst += dstStride, src += srcStride) std::memcpy(dst, src, bytes);
 }
 
-int64_t find_element(const std::string& key, const std::vector<PlyElement>& list)
+// Field width known at compile time; the memcpy becomes one or two plain moves
+template<size_t Bytes>
+void deinterleave_fixed(uint8_t* dst, size_t dstStride, const uint8_t* src, size_t srcStride, size_t count)
 {
-    for (size_t i = 0; i < list.size(); i++) if (list[i].name == key) return i;
-    return -1;
+    for (size_t r = 0; r < count; ++r, dst += dstStride, src += srcStride) std::memcpy(dst, src, Bytes);
 }
 
-int64_t find_property(const std::string& key, const std::vector<PlyProperty>& list)
+// Field width and source stride known at compile time, packed destination. Covers the common
+// vertex layouts (e.g. xyz out of xyz + normal, xyz + normal + rgb, xyz + rgb).
+template<size_t Bytes, size_t SrcStride>
+void deinterleave_packed(uint8_t* dst, size_t, const uint8_t* src, size_t, size_t count)
 {
-    for (size_t i = 0; i < list.size(); ++i) if (list[i].name == key) return i;
-    return -1;
+    size_t r = 0;
+    for (; r + 4 <= count; r += 4, dst += 4 * Bytes, src += 4 * SrcStride)
+    {
+        std::memcpy(dst + 0 * Bytes, src + 0 * SrcStride, Bytes);
+        std::memcpy(dst + 1 * Bytes, src + 1 * SrcStride, Bytes);
+        std::memcpy(dst + 2 * Bytes, src + 2 * SrcStride, Bytes);
+        std::memcpy(dst + 3 * Bytes, src + 3 * SrcStride, Bytes);
+    }
+    for (; r < count; ++r, dst += Bytes, src += SrcStride) std::memcpy(dst, src, Bytes);
 }
 
-bool PlyFile::PlyFileImpl::parse_header(std::istream& is)
+// Three 4-byte fields (xyz, normals) into a packed destination. Each record is moved with a
+// 16-byte load and store; the 4 extra bytes written are overwritten by the next record, so the
+// wide path stops one record early to stay inside both buffers.
+template<size_t SrcStride>
+void deinterleave_packed_12(uint8_t* dst, size_t, const uint8_t* src, size_t srcStrideRuntime, size_t count)
 {
-    std::string line;
-    while (std::getline(is, line))
+    const size_t srcStride = SrcStride ? SrcStride : srcStrideRuntime;
+    size_t r = 0;
+#if defined(TINYPLY_AVX2)
+    // Four records per iteration: pairs of records are packed into 24 bytes with a cross-lane permute
+    const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    for (; r + 4 < count; r += 4, dst += 48, src += 4 * srcStride)
     {
-        std::istringstream ls(line);
-        std::string token;
-        ls >> token;
-        if (token == "ply" || token == "PLY" || token == "") continue;
-        else if (token == "comment")    read_header_text(line, ls, comments, 8);
-        else if (token == "format")     read_header_format(ls);
-        else if (token == "element")    read_header_element(ls);
-        else if (token == "property")   read_header_property(ls);
-        else if (token == "obj_info")   read_header_text(line, ls, objInfo, 9);
-        else if (token == "end_header") break;
-        else return false; // unexpected header field
+        const __m256i a = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src))), _mm_loadu_si128((const __m128i*)(src + srcStride)), 1);
+        const __m256i b = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + 2 * srcStride))), _mm_loadu_si128((const __m128i*)(src + 3 * srcStride)), 1);
+        _mm256_storeu_si256((__m256i*)(dst), _mm256_permutevar8x32_epi32(a, compact));
+        _mm256_storeu_si256((__m256i*)(dst + 24), _mm256_permutevar8x32_epi32(b, compact));
     }
-    return true;
+#endif
+#if defined(TINYPLY_SSE2)
+    for (; r + 1 < count; ++r, dst += 12, src += srcStride)
+    {
+        _mm_storeu_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+    }
+#endif
+    for (; r < count; ++r, dst += 12, src += srcStride) std::memcpy(dst, src, 12);
 }
 
-void PlyFile::PlyFileImpl::read_header_text(std::string line, std::istream& is, std::vector<std::string>& place, int erase)
+// Four 4-byte fields or two 8-byte fields into a packed destination
+template<size_t SrcStride>
+void deinterleave_packed_16(uint8_t* dst, size_t, const uint8_t* src, size_t srcStrideRuntime, size_t count)
 {
-    place.push_back((erase > 0) ? line.erase(0, erase) : line);
+    const size_t srcStride = SrcStride ? SrcStride : srcStrideRuntime;
+    size_t r = 0;
+#if defined(TINYPLY_SSE2)
+    for (; r < count; ++r, dst += 16, src += srcStride)
+    {
+        _mm_storeu_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+    }
+#endif
+    for (; r < count; ++r, dst += 16, src += srcStride) std::memcpy(dst, src, 16);
 }
 
-void PlyFile::PlyFileImpl::read_header_format(std::istream& is)
+// Three 8-byte fields (double precision xyz) into a packed destination, same overlap scheme as above
+template<size_t SrcStride>
+void deinterleave_packed_24(uint8_t* dst, size_t, const uint8_t* src, size_t srcStrideRuntime, size_t count)
 {
-    std::string s;
-    (is >> s);
-    if (s == "binary_little_endian") isBinary = true;
-    else if (s == "binary_big_endian") isBinary = isBigEndian = true;
+    const size_t srcStride = SrcStride ? SrcStride : srcStrideRuntime;
+    size_t r = 0;
+#if defined(TINYPLY_AVX2)
+    for (; r + 1 < count; ++r, dst += 24, src += srcStride)
+    {
+        _mm256_storeu_si256((__m256i*)dst, _mm256_loadu_si256((const __m256i*)src));
+    }
+#elif defined(TINYPLY_SSE2)
+    for (; r < count; ++r, dst += 24, src += srcStride)
+    {
+        _mm_storeu_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+        std::memcpy(dst + 16, src + 16, 8);
+    }
+#endif
+    for (; r < count; ++r, dst += 24, src += srcStride) std::memcpy(dst, src, 24);
 }
 
-void PlyFile::PlyFileImpl::read_header_element(std::istream& is)
+// Records that are copied whole: one memcpy for the entire run
+inline void deinterleave_contiguous(uint8_t* dst, size_t dstStride, const uint8_t* src, size_t, size_t count)
 {
-    elements.emplace_back(is);
+    std::memcpy(dst, src, dstStride * count);
 }
 
-void PlyFile::PlyFileImpl::read_header_property(std::istream& is)
+inline deinterleave_fn select_deinterleave_kernel(size_t bytes, size_t srcStride, size_t dstStride)
+{
+    if (dstStride == bytes && srcStride == bytes) return &deinterleave_contiguous;
+
+    if (dstStride == bytes)
+    {
+        // Specializations for common vertex strides (in bytes): xyz, xyz + rgb(a), xyz + normal,
+        // xyz + normal + rgb(a), and the same with an extra float (confidence, intensity, ...)
+        if (bytes == 12)
+        {
+            switch (srcStride)
+            {
+            case 15: return &deinterleave_packed_12<15>;
+            case 16: return &deinterleave_packed_12<16>;
+            case 24: return &deinterleave_packed_12<24>;
+            case 27: return &deinterleave_packed_12<27>;
+            case 28: return &deinterleave_packed_12<28>;
+            case 31: return &deinterleave_packed_12<31>;
+            case 32: return &deinterleave_packed_12<32>;
+            default: return &deinterleave_packed_12<0>;
+            }
+        }
+        if (bytes == 16) return (srcStride == 32) ? &deinterleave_packed_16<32> : &deinterleave_packed_16<0>;
+        if (bytes == 24) return (srcStride == 48) ? &deinterleave_packed_24<48> : &deinterleave_packed_24<0>;
+        if (bytes == 3)
+        {
+            switch (srcStride)
+            {
+            case 15: return &deinterleave_packed<3, 15>;
+            case 27: return &deinterleave_packed<3, 27>;
+            case 31: return &deinterleave_packed<3, 31>;
+            default: break;
+            }
+        }
+    }
+
+    switch (bytes)
+    {
+    case 1:  return &deinterleave_fixed<1>;
+    case 2:  return &deinterleave_fixed<2>;
+    case 3:  return &deinterleave_fixed<3>;
+    case 4:  return &deinterleave_fixed<4>;
+    case 6:  return &deinterleave_fixed<6>;
+    case 8:  return &deinterleave_fixed<8>;
+    case 12: return &deinterleave_fixed<12>;
+    case 16: return &deinterleave_fixed<16>;
+    case 24: return &deinterleave_fixed<24>;
+    case 32: return &deinterleave_fixed<32>;
+    default: return nullptr;
+    }
+}
+
+// Conversion kernels: convert `count` packed values from one property type to another, as by
+// `static_cast`. Requests with a target type run these over each decoded block (or value), so the
+// converted data is written straight into the destination layout. The usual widening and
+// narrowing pairs for positions, colors and indices have SIMD versions.
+typedef void(*convert_fn)(uint8_t* dst, const uint8_t* src, size_t count);
+
+template<typename From, typename To>
+void convert_values(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i, dst += sizeof(To), src += sizeof(From))
+    {
+        From v;
+        std::memcpy(&v, src, sizeof(From));
+        const To w = static_cast<To>(v);
+        std::memcpy(dst, &w, sizeof(To));
+    }
+}
+
+#if defined(TINYPLY_SSE2)
+// double -> float (e.g. double precision scans to GL positions)
+template<> inline void convert_values<double, float>(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i = 0;
+#if defined(TINYPLY_AVX2)
+    for (; i + 4 <= count; i += 4) _mm_storeu_ps((float*)dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd((const double*)src + i)));
+#endif
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd((const double*)src + i));
+        const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd((const double*)src + i + 2));
+        _mm_storeu_ps((float*)dst + i, _mm_movelh_ps(lo, hi));
+    }
+    for (; i < count; ++i) { double v; std::memcpy(&v, src + i * sizeof(double), sizeof(v)); const float w = static_cast<float>(v); std::memcpy(dst + i * sizeof(float), &w, sizeof(w)); }
+}
+template<> inline void convert_values<float, double>(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 v = _mm_loadu_ps((const float*)src + i);
+        _mm_storeu_pd((double*)dst + i, _mm_cvtps_pd(v));
+        _mm_storeu_pd((double*)dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    for (; i < count; ++i) { float v; std::memcpy(&v, src + i * sizeof(float), sizeof(v)); const double w = v; std::memcpy(dst + i * sizeof(double), &w, sizeof(w)); }
+}
+
+// Eight 16-bit integers at a time, widened to 32 bits (quantized positions, 16-bit indices)
+template<bool Signed> inline void widen_16_to_32(const uint8_t* src, __m128i& lo, __m128i& hi)
+{
+    const __m128i v = _mm_loadu_si128((const __m128i*)src);
+    if (Signed)
+    {
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    }
+    else
+    {
+        lo = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+        hi = _mm_unpackhi_epi16(v, _mm_setzero_si128());
+    }
+}
+template<> inline void convert_values<int16_t, float>(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo, hi;
+        widen_16_to_32<true>(src + i * 2, lo, hi);
+        _mm_storeu_ps((float*)dst + i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps((float*)dst + i + 4, _mm_cvtepi32_ps(hi));
+    }
+    for (; i < count; ++i) { int16_t v; std::memcpy(&v, src + i * 2, sizeof(v)); const float w = v; std::memcpy(dst + i * 4, &w, sizeof(w)); }
+}
+template<> inline void convert_values<uint16_t, float>(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo, hi;
+        widen_16_to_32<false>(src + i * 2, lo, hi);
+        _mm_storeu_ps((float*)dst + i, _mm_cvtepi32_ps(lo));
+        _mm_storeu_ps((float*)dst + i + 4, _mm_cvtepi32_ps(hi));
+    }
+    for (; i < count; ++i) { uint16_t v; std::memcpy(&v, src + i * 2, sizeof(v)); const float w = v; std::memcpy(dst + i * 4, &w, sizeof(w)); }
+}
+template<> inline void convert_values<uint16_t, uint32_t>(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo, hi;
+        widen_16_to_32<false>(src + i * 2, lo, hi);
+        _mm_storeu_si128((__m128i*)(dst + i * 4), lo);
+        _mm_storeu_si128((__m128i*)(dst + i * 4 + 16), hi);
+    }
+    for (; i < count; ++i) { uint16_t v; std::memcpy(&v, src + i * 2, sizeof(v)); const uint32_t w = v; std::memcpy(dst + i * 4, &w, sizeof(w)); }
+}
+
+// Sixteen bytes at a time, zero extended to 32 bits (8-bit indices, colors)
+inline void widen_8_to_32(const uint8_t* src, __m128i out[4])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v = _mm_loadu_si128((const __m128i*)src);
+    const __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+    out[0] = _mm_unpacklo_epi16(lo, zero);
+    out[1] = _mm_unpackhi_epi16(lo, zero);
+    out[2] = _mm_unpacklo_epi16(hi, zero);
+    out[3] = _mm_unpackhi_epi16(hi, zero);
+}
+template<> inline void convert_values<uint8_t, uint32_t>(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v[4];
+        widen_8_to_32(src + i, v);
+        for (int k = 0; k < 4; ++k) _mm_storeu_si128((__m128i*)(dst + (i + 4 * k) * 4), v[k]);
+    }
+    for (; i < count; ++i) { const uint32_t w = src[i]; std::memcpy(dst + i * 4, &w, sizeof(w)); }
+}
+template<> inline void convert_values<uint8_t, float>(uint8_t* dst, const uint8_t* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v[4];
+        widen_8_to_32(src + i, v);
+        for (int k = 0; k < 4; ++k) _mm_storeu_ps((float*)dst + i + 4 * k, _mm_cvtepi32_ps(v[k]));
+    }
+    for (; i < count; ++i) { const float w = src[i]; std::memcpy(dst + i * 4, &w, sizeof(w)); }
+}
+#endif
+
+template<typename From> inline convert_fn select_convert_kernel_from(const Type to)
+{
+    switch (to)
+    {
+    case Type::INT8:    return &convert_values<From, int8_t>;
+    case Type::UINT8:   return &convert_values<From, uint8_t>;
+    case Type::INT16:   return &convert_values<From, int16_t>;
+    case Type::UINT16:  return &convert_values<From, uint16_t>;
+    case Type::INT32:   return &convert_values<From, int32_t>;
+    case Type::UINT32:  return &convert_values<From, uint32_t>;
+    case Type::FLOAT32: return &convert_values<From, float>;
+    case Type::FLOAT64: return &convert_values<From, double>;
+    default: return nullptr;
+    }
+}
+
+// Returns nullptr when no conversion is needed
+inline convert_fn select_convert_kernel(const Type from, const Type to)
+{
+    if (from == to || to == Type::INVALID) return nullptr;
+    switch (from)
+    {
+    case Type::INT8:    return select_convert_kernel_from<int8_t>(to);
+    case Type::UINT8:   return select_convert_kernel_from<uint8_t>(to);
+    case Type::INT16:   return select_convert_kernel_from<int16_t>(to);
+    case Type::UINT16:  return select_convert_kernel_from<uint16_t>(to);
+    case Type::INT32:   return select_convert_kernel_from<int32_t>(to);
+    case Type::UINT32:  return select_convert_kernel_from<uint32_t>(to);
+    case Type::FLOAT32: return select_convert_kernel_from<float>(to);
+    case Type::FLOAT64: return select_convert_kernel_from<double>(to);
+    default: return nullptr;
+    }
+}
+
+// Whitespace tokenizer for ascii payloads. The stream is consumed in large chunks (or in place,
+// for mapped files) and tokens are handed out as [begin, end) pointers; a token is never split
+// across chunks. The character after a token is always readable, so it can be handed to strtod.
+class AsciiTokenizer
+{
+    std::istream& is;
+    std::vector<char> storage;
+    std::string lastToken;
+    const char* cur{ nullptr };
+    const char* end{ nullptr };
+    bool exhausted{ false };
+    size_t bytesRead{ 0 };
+    size_t readCalls{ 0 };
+
+    // Every ascii control character counts as a separator, like the whitespace the format allows
+    static bool is_space(char c) { return static_cast<unsigned char>(c) <= ' '; }
+
+    // Move the unread tail to the front, append the next chunk and keep a terminator after it
+    void refill()
+    {
+        const size_t keep = size_t(end - cur);
+        if (keep * 2 > storage.size() - 1)
+        {
+            std::vector<char> grown(keep * 2 + 1);
+            std::memcpy(grown.data(), cur, keep);
+            storage.swap(grown);
+        }
+        else std::memmove(storage.data(), cur, keep);
+
+        const size_t room = storage.size() - 1 - keep;
+        is.read(storage.data() + keep, std::streamsize(room));
+        const size_t got = size_t(is.gcount());
+        bytesRead += got;
+        ++readCalls;
+        exhausted = got < room;
+        storage[keep + got] = '\0';
+        cur = storage.data();
+        end = cur + keep + got;
+    }
+
+public:
+    AsciiTokenizer(std::istream& is, size_t chunkSize) : is(is)
+    {
+        if (memory_streambuf* memory = dynamic_cast<memory_streambuf*>(is.rdbuf()))
+        {
+            cur = reinterpret_cast<const char*>(memory->cursor());
+            end = cur + memory->remaining();
+            bytesRead = memory->remaining();
+            memory->advance(memory->remaining());
+            exhausted = true;
+        }
+        else
+        {
+            storage.resize(std::max<size_t>(chunkSize, 64) + 1);
+            cur = end = storage.data();
+        }
+    }
+
+    // Tokenize an in-memory range, e.g. one chunk of lines of a larger payload
+    AsciiTokenizer(std::istream& is, const char* begin, const char* end) : is(is), cur(begin), end(end), exhausted(true) {}
+
+    size_t bytes_read() const { return bytesRead; }
+    size_t read_calls() const { return readCalls; }
+
+    bool next(const char*& tokenBegin, const char*& tokenEnd)
+    {
+        for (;;)
+        {
+            while (cur < end && is_space(*cur)) ++cur;
+            if (cur == end)
+            {
+                if (exhausted) return false;
+                refill();
+                continue;
+            }
+
+            const char* p = cur;
+            while (p < end && !is_space(*p)) ++p;
+            if (p == end && !exhausted)
+            {
+                refill(); // the token may continue in the next chunk
+                continue;
+            }
+
+            tokenBegin = cur;
+            tokenEnd = p;
+            cur = p;
+
+            // Only a token ending exactly at the end of a mapping lacks a readable terminator
+            if (p == end && storage.empty())
+            {
+                lastToken.assign(tokenBegin, tokenEnd);
+                tokenBegin = lastToken.c_str();
+                tokenEnd = tokenBegin + lastToken.size();
+            }
+            return true;
+        }
+    }
+};
+
+inline uint32_t popcount32(uint32_t v)
+{
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    return (((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+inline size_t count_newlines(const char* p, const char* end)
+{
+    size_t n = 0;
+#if defined(TINYPLY_AVX2)
+    const __m256i nl32 = _mm256_set1_epi8('\n');
+    for (; p + 32 <= end; p += 32) n += popcount32(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), nl32))));
+#endif
+#if defined(TINYPLY_SSE2)
+    const __m128i nl16 = _mm_set1_epi8('\n');
+    for (; p + 16 <= end; p += 16) n += popcount32(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), nl16))));
+#endif
+    for (; p < end; ++p) n += (*p == '\n');
+    return n;
+}
+
+// Sparse line index of an in-memory ascii payload: the number of newlines in each fixed-size
+// block, accumulated. Finding where a line starts costs a binary search plus a scan of one block.
+class NewlineIndex
+{
+    const char* begin;
+    const char* end;
+    size_t blockSize;
+    std::vector<size_t> linesBefore; // newlines before block i; one extra entry holds the total
+
+public:
+    NewlineIndex(const char* begin, const char* end, unsigned int numThreads, size_t blockSize = 1 << 20)
+        : begin(begin), end(end), blockSize(blockSize)
+    {
+        const size_t numBlocks = (size_t(end - begin) + blockSize - 1) / blockSize;
+        linesBefore.assign(numBlocks + 1, 0);
+
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < numThreads; ++t)
+        {
+            workers.emplace_back([&, t]()
+            {
+                for (size_t b = t; b < numBlocks; b += numThreads)
+                {
+                    const char* blockBegin = begin + b * blockSize;
+                    linesBefore[b + 1] = count_newlines(blockBegin, std::min(end, blockBegin + blockSize));
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        for (size_t b = 1; b <= numBlocks; ++b) linesBefore[b] += linesBefore[b - 1];
+    }
+
+    // Lines that start within the payload, counting a last line without a trailing newline
+    size_t num_lines() const { return linesBefore.back() + ((begin < end && end[-1] != '\n') ? 1 : 0); }
+
+    // Pointer to the first character of `line`, or `end` if the payload has fewer lines
+    const char* line_start(size_t line) const
+    {
+        if (line == 0) return begin;
+        if (line > linesBefore.back()) return end;
+        // the block holding the line-th newline
+        const size_t b = size_t(std::lower_bound(linesBefore.begin(), linesBefore.end(), line) - linesBefore.begin()) - 1;
+        size_t remaining = line - linesBefore[b];
+        const char* p = begin + b * blockSize;
+        for (;; ++p) if (*p == '\n' && --remaining == 0) return p + 1;
+    }
+};
+
+// Decimal to binary floating point conversion for the ascii decoder, following the Eisel-Lemire
+// algorithm (Lemire, "Number Parsing at a Gigabyte per Second", 2021). The decimal significand is
+// multiplied by a 128-bit truncated power of five; when the product can't be rounded unambiguously,
+// or the value is out of the table range, subnormal or out of range, we defer to strtod/strtof.
+// Results are therefore always bit-identical to the C library.
+
+// Normalized 128-bit approximations of 5^q for q in [ply_pow5_min, ply_pow5_max], high word first
+static const int ply_pow5_min = -64;
+static const int ply_pow5_max = 64;
+static const uint64_t ply_pow5_128[] =
+{
+    0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull, 0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull,
+    0x83a3eeeef9153e89ull, 0x1953cf68300424acull, 0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull,
+    0xcdb02555653131b6ull, 0x3792f412cb06794dull, 0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull,
+    0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull, 0xc8de047564d20a8bull, 0xf245825a5a445275ull,
+    0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull, 0x9ced737bb6c4183dull, 0x55464dd69685606bull,
+    0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull, 0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull,
+    0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull, 0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull,
+    0xef73d256a5c0f77cull, 0x963e66858f6d4440ull, 0x95a8637627989aadull, 0xdde7001379a44aa8ull,
+    0xbb127c53b17ec159ull, 0x5560c018580d5d52ull, 0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull,
+    0x9226712162ab070dull, 0xcab3961304ca70e8ull, 0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull,
+    0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull, 0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull,
+    0xb267ed1940f1c61cull, 0x55f038b237591ed3ull, 0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull,
+    0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull, 0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull,
+    0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull, 0x881cea14545c7575ull, 0x7e50d64177da2e54ull,
+    0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull, 0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull,
+    0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull, 0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull,
+    0xcfb11ead453994baull, 0x67de18eda5814af2ull, 0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull,
+    0xa2425ff75e14fc31ull, 0xa1258379a94d028dull, 0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull,
+    0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull, 0x9e74d1b791e07e48ull, 0x775ea264cf55347eull,
+    0xc612062576589ddaull, 0x95364afe032a819eull, 0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull,
+    0x9abe14cd44753b52ull, 0xc4926a9672793543ull, 0xc16d9a0095928a27ull, 0x75b7053c0f178294ull,
+    0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull, 0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull,
+    0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull, 0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull,
+    0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull, 0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull,
+    0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull, 0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull,
+    0xb424dc35095cd80full, 0x538484c19ef38c95ull, 0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull,
+    0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull, 0xafebff0bcb24aafeull, 0xf78f69a51539d749ull,
+    0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull, 0x89705f4136b4a597ull, 0x31680a88f8953031ull,
+    0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull, 0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull,
+    0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull, 0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull,
+    0xd1b71758e219652bull, 0xd3c36113404ea4a9ull, 0x83126e978d4fdf3bull, 0x645a1cac083126eaull,
+    0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull, 0xccccccccccccccccull, 0xcccccccccccccccdull,
+    0x8000000000000000ull, 0x0000000000000000ull, 0xa000000000000000ull, 0x0000000000000000ull,
+    0xc800000000000000ull, 0x0000000000000000ull, 0xfa00000000000000ull, 0x0000000000000000ull,
+    0x9c40000000000000ull, 0x0000000000000000ull, 0xc350000000000000ull, 0x0000000000000000ull,
+    0xf424000000000000ull, 0x0000000000000000ull, 0x9896800000000000ull, 0x0000000000000000ull,
+    0xbebc200000000000ull, 0x0000000000000000ull, 0xee6b280000000000ull, 0x0000000000000000ull,
+    0x9502f90000000000ull, 0x0000000000000000ull, 0xba43b74000000000ull, 0x0000000000000000ull,
+    0xe8d4a51000000000ull, 0x0000000000000000ull, 0x9184e72a00000000ull, 0x0000000000000000ull,
+    0xb5e620f480000000ull, 0x0000000000000000ull, 0xe35fa931a0000000ull, 0x0000000000000000ull,
+    0x8e1bc9bf04000000ull, 0x0000000000000000ull, 0xb1a2bc2ec5000000ull, 0x0000000000000000ull,
+    0xde0b6b3a76400000ull, 0x0000000000000000ull, 0x8ac7230489e80000ull, 0x0000000000000000ull,
+    0xad78ebc5ac620000ull, 0x0000000000000000ull, 0xd8d726b7177a8000ull, 0x0000000000000000ull,
+    0x878678326eac9000ull, 0x0000000000000000ull, 0xa968163f0a57b400ull, 0x0000000000000000ull,
+    0xd3c21bcecceda100ull, 0x0000000000000000ull, 0x84595161401484a0ull, 0x0000000000000000ull,
+    0xa56fa5b99019a5c8ull, 0x0000000000000000ull, 0xcecb8f27f4200f3aull, 0x0000000000000000ull,
+    0x813f3978f8940984ull, 0x4000000000000000ull, 0xa18f07d736b90be5ull, 0x5000000000000000ull,
+    0xc9f2c9cd04674edeull, 0xa400000000000000ull, 0xfc6f7c4045812296ull, 0x4d00000000000000ull,
+    0x9dc5ada82b70b59dull, 0xf020000000000000ull, 0xc5371912364ce305ull, 0x6c28000000000000ull,
+    0xf684df56c3e01bc6ull, 0xc732000000000000ull, 0x9a130b963a6c115cull, 0x3c7f400000000000ull,
+    0xc097ce7bc90715b3ull, 0x4b9f100000000000ull, 0xf0bdc21abb48db20ull, 0x1e86d40000000000ull,
+    0x96769950b50d88f4ull, 0x1314448000000000ull, 0xbc143fa4e250eb31ull, 0x17d955a000000000ull,
+    0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull, 0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull,
+    0xb7abc627050305adull, 0xf14a3d9e40000000ull, 0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull,
+    0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull, 0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull,
+    0xe0352f62a19e306eull, 0xd50b2037ad200000ull, 0x8c213d9da502de45ull, 0x4526f422cc340000ull,
+    0xaf298d050e4395d6ull, 0x9670b12b7f410000ull, 0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull,
+    0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull, 0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull,
+    0xd5d238a4abe98068ull, 0x72a4904598d6d880ull, 0x85a36366eb71f041ull, 0x47a6da2b7f864750ull,
+    0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull, 0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull,
+    0x82818f1281ed449full, 0xbff8f10e7a8921a4ull, 0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull,
+    0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull, 0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull,
+    0x9f4f2726179a2245ull, 0x01d762422c946590ull, 0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull,
+    0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull, 0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full,
+    0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull
+};
+
+struct ply_uint128 { uint64_t low, high; };
+
+inline ply_uint128 ply_full_multiplication(uint64_t a, uint64_t b)
+{
+    ply_uint128 r;
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+    r.low = static_cast<uint64_t>(p);
+    r.high = static_cast<uint64_t>(p >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    r.low = _umul128(a, b, &r.high);
+#else
+    const uint64_t aLo = a & 0xFFFFFFFFu, aHi = a >> 32, bLo = b & 0xFFFFFFFFu, bHi = b >> 32;
+    const uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFu) + (hl & 0xFFFFFFFFu);
+    r.low = (mid << 32) | (ll & 0xFFFFFFFFu);
+    r.high = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+    return r;
+}
+
+inline int ply_leading_zeroes(uint64_t v)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(v);
+#else
+    int n = 0;
+    while (!(v & (uint64_t(1) << 63))) { v <<= 1; ++n; }
+    return n;
+#endif
+}
+
+template<typename T> struct ply_float_traits;
+template<> struct ply_float_traits<double>
+{
+    typedef uint64_t bits;
+    static const int mantissa_bits = 52, minimum_exponent = -1023, infinite_power = 0x7FF;
+    static const int min_round_to_even = -4, max_round_to_even = 23, max_fast_power = 22;
+    static const uint64_t max_fast_mantissa = uint64_t(2) << 52;
+    static double exact_power_of_ten(int q) { static const double p[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 }; return p[q]; }
+    static double fallback(const char* b) { return std::strtod(b, nullptr); }
+};
+template<> struct ply_float_traits<float>
+{
+    typedef uint32_t bits;
+    static const int mantissa_bits = 23, minimum_exponent = -127, infinite_power = 0xFF;
+    static const int min_round_to_even = -17, max_round_to_even = 10, max_fast_power = 10;
+    static const uint64_t max_fast_mantissa = uint64_t(2) << 23;
+    static float exact_power_of_ten(int q) { static const float p[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f }; return p[q]; }
+    static float fallback(const char* b) { return std::strtof(b, nullptr); }
+};
+
+// Returns false when the fast algorithm can't guarantee the correctly rounded result
+template<typename T> inline bool ply_eisel_lemire(uint64_t w, int64_t q, bool negative, T& result)
+{
+    typedef ply_float_traits<T> traits;
+    if (q < ply_pow5_min || q > ply_pow5_max) return false;
+
+    const int lz = ply_leading_zeroes(w);
+    w <<= lz;
+
+    const size_t index = 2 * size_t(q - ply_pow5_min);
+    ply_uint128 product = ply_full_multiplication(w, ply_pow5_128[index]);
+    const uint64_t precisionMask = uint64_t(0xFFFFFFFFFFFFFFFF) >> (traits::mantissa_bits + 3);
+    if ((product.high & precisionMask) == precisionMask)
+    {
+        const ply_uint128 second = ply_full_multiplication(w, ply_pow5_128[index + 1]);
+        product.low += second.high;
+        if (second.high > product.low) product.high++;
+    }
+    if (product.low == 0xFFFFFFFFFFFFFFFF) return false; // the truncated power may be too small
+
+    const int upperbit = int(product.high >> 63);
+    const int shift = upperbit + 64 - traits::mantissa_bits - 3;
+    uint64_t mantissa = product.high >> shift;
+    int32_t power2 = int32_t((((152170 + 65536) * q) >> 16) + 63) + upperbit - lz - traits::minimum_exponent;
+    if (power2 <= 0) return false; // subnormal
+
+    // Exactly halfway between two floats: round to even instead of up
+    if (product.low <= 1 && q >= traits::min_round_to_even && q <= traits::max_round_to_even && (mantissa & 3) == 1)
+    {
+        if ((mantissa << shift) == product.high) mantissa &= ~uint64_t(1);
+    }
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= (uint64_t(2) << traits::mantissa_bits))
+    {
+        mantissa = (uint64_t(1) << traits::mantissa_bits);
+        power2++;
+    }
+    mantissa &= ~(uint64_t(1) << traits::mantissa_bits);
+    if (power2 >= traits::infinite_power) return false;
+
+    const typename traits::bits word = static_cast<typename traits::bits>(mantissa | (uint64_t(power2) << traits::mantissa_bits) | (uint64_t(negative) << (traits::mantissa_bits + (sizeof(T) == 8 ? 11 : 8))));
+    std::memcpy(&result, &word, sizeof(T));
+    return true;
+}
+
+// Parse the decimal number at the start of [b, e); the character at `e` must be readable
+template<typename T> inline T ply_parse_float(const char* b, const char* e)
+{
+    typedef ply_float_traits<T> traits;
+    const char* p = b;
+    const bool negative = (p < e && *p == '-');
+    if (p < e && (*p == '-' || *p == '+')) ++p;
+
+    uint64_t w = 0;
+    int64_t q = 0;
+    int digits = 0; // significant digits accumulated into w
+    bool any = false;
+
+    for (; p < e && static_cast<unsigned>(*p - '0') < 10; ++p, any = true)
+    {
+        if (digits < 19) { w = w * 10 + uint64_t(*p - '0'); digits += (w != 0); }
+        else return traits::fallback(b);
+    }
+    if (p < e && *p == '.')
+    {
+        for (++p; p < e && static_cast<unsigned>(*p - '0') < 10; ++p, any = true)
+        {
+            if (digits < 19) { w = w * 10 + uint64_t(*p - '0'); digits += (w != 0); --q; }
+            else return traits::fallback(b);
+        }
+    }
+    if (!any || (p < e && (*p == 'x' || *p == 'X'))) return traits::fallback(b); // inf, nan, hex: same as the C library
+
+    if (p < e && (*p == 'e' || *p == 'E'))
+    {
+        const char* x = p + 1;
+        const bool negativeExponent = (x < e && *x == '-');
+        if (x < e && (*x == '-' || *x == '+')) ++x;
+        if (x < e && static_cast<unsigned>(*x - '0') < 10)
+        {
+            int64_t exponent = 0;
+            for (; x < e && static_cast<unsigned>(*x - '0') < 10; ++x) if (exponent < 100000) exponent = exponent * 10 + (*x - '0');
+            q += negativeExponent ? -exponent : exponent;
+        }
+    }
+
+    if (w == 0) return negative ? -T(0) : T(0);
+
+    // Clinger's fast path: both operands are exact, so one correctly rounded operation suffices
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    if (q >= -traits::max_fast_power && q <= traits::max_fast_power && w <= traits::max_fast_mantissa)
+    {
+        T value = static_cast<T>(w);
+        value = (q < 0) ? value / traits::exact_power_of_ten(int(-q)) : value * traits::exact_power_of_ten(int(q));
+        return negative ? -value : value;
+    }
+#endif
+
+    T value;
+    if (ply_eisel_lemire<T>(w, q, negative, value)) return value;
+    return traits::fallback(b);
+}
+
+// Matches `std::istream >> T` for well-formed input, including modular wrap-around of negative
+// values read into unsigned types. Parsing stops at the first character that is not a digit.
+template<typename T> inline T ascii_to_integer(const char* b, const char* e)
+{
+    bool negative = false;
+    if (b < e && (*b == '-' || *b == '+')) negative = (*b++ == '-');
+    uint64_t v = 0;
+    for (; b < e && static_cast<unsigned>(*b - '0') < 10; ++b) v = v * 10 + static_cast<uint64_t>(*b - '0');
+    return static_cast<T>(negative ? (0 - v) : v);
+}
+
+inline void ascii_to_property(const Type t, const char* b, const char* e, uint8_t* dest)
+{
+    switch (t)
+    {
+    case Type::INT8:    { int8_t v = static_cast<int8_t>(ascii_to_integer<int32_t>(b, e));     std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::UINT8:   { uint8_t v = static_cast<uint8_t>(ascii_to_integer<uint32_t>(b, e));  std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::INT16:   { int16_t v = ascii_to_integer<int16_t>(b, e);   std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::UINT16:  { uint16_t v = ascii_to_integer<uint16_t>(b, e); std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::INT32:   { int32_t v = ascii_to_integer<int32_t>(b, e);   std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::UINT32:  { uint32_t v = ascii_to_integer<uint32_t>(b, e); std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::FLOAT32: { float v = ply_parse_float<float>(b, e);   std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::FLOAT64: { double v = ply_parse_float<double>(b, e); std::memcpy(dest, &v, sizeof(v)); break; }
+    case Type::INVALID: throw std::invalid_argument("invalid ply property");
+    }
+}
+
+struct PlyFile::PlyFileImpl
+{
+    struct PlyDataCursor
+    {
+        size_t byteOffset{ 0 };
+        std::vector<std::pair<Buffer, size_t>> spilled; // full arena chunks and the bytes used in each
+        size_t spilledBytes{ 0 };
+        size_t numPolygons{ 0 }; // triangulated faces only
+    };
+
+    struct ParsingHelper
+    {
+        std::shared_ptr<PlyData> data;
+        std::shared_ptr<PlyDataCursor> cursor;
+        uint32_t list_size_hint;
+        bool aliased{ false }; // buffer points into a file mapping; nothing to decode
+        bool triangulate{ false }; // list of vertex indices, decoded as fan triangles
+        Type outputType{ Type::INVALID }; // requested conversion, if any
+        std::shared_ptr<PlyData> polygonOffsets;
+        size_t structOffset{ 0 }; // `request<T>`: offset of the field within T
+        size_t structStride{ 0 }; // `request<T>`: sizeof(T), otherwise 0
+        size_t batchSize{ 0 }; // `request_batches`: records per batch, otherwise 0
+    };
+
+    // A `request_batches` group. Its buffer holds the records decoded since the last batch.
+    struct BatchRequest
+    {
+        ParsingHelper* helper;
+        size_t element;
+        std::function<void(const PlyData&, size_t)> callback;
+        size_t pending{ 0 }; // records in the current batch
+        size_t first{ 0 }; // index of the first of them
+    };
+
+    // A `request<T>` group. Its PlyData ends up aliasing |storage|, the caller's vector.
+    // Layout::Columns requests are a struct whose fields are a column apart, with the width
+    // of one value as stride; their storage is allocated by `read`.
+    struct StructRequest
+    {
+        std::shared_ptr<PlyData> data;
+        size_t element;
+        size_t stride; // sizeof(T)
+        size_t bytes; // of |storage|
+        uint8_t* storage;
+        std::shared_ptr<void> owner;
+        bool columns{ false };
+        bool direct{ false }; // decoded in place by `parse_fixed_element_binary`
+    };
+
+    struct PropertyLookup
+    {
+        ParsingHelper* helper{ nullptr };
+        bool skip{ false };
+        size_t prop_stride{ 0 }; // precomputed
+        size_t list_stride{ 0 }; // precomputed
+        size_t dst_stride{ 0 }; // bytes per value in the destination buffer
+        convert_fn convert{ nullptr }; // set when the destination type differs
+    };
+
+    // One step of the decode program that `parse_element_binary` runs for every record of an
+    // element. Adjacent properties that are copied, converted or skipped alike share one op.
+    struct DecodeOp
+    {
+        enum Kind : uint8_t { Copy, Convert, Skip, CopyList, ConvertList, TriangulateList, SkipList };
+        Kind kind;
+        ParsingHelper* helper; // destination group, null for skips
+        size_t bytes; // fixed-size ops: source bytes per record
+        size_t width; // bytes per source value
+        size_t dstWidth; // bytes per converted value
+        convert_fn convert;
+        Type valueType; // lists: type of the values
+        Type countType; // lists: type of the count
+        size_t countWidth;
+    };
+
+    // Requests by element and property index: unique by construction, and known without hashing names
+    static uint64_t property_key(const size_t element, const size_t property) { return (uint64_t(element) << 32) | uint64_t(property); }
+    std::unordered_map<uint64_t, ParsingHelper> userData;
+    std::vector<StructRequest> structRequests;
+    std::vector<BatchRequest> batchRequests;
+    std::vector<std::pair<std::shared_ptr<PlyData>, size_t>> splatArrays; // `request_gaussian_splats` arrays and floats per splat
+
+    bool isBinary = false;
+    bool isBigEndian = false;
+    size_t headerBytes = 0; // consumed by `parse_header`, up to and including `end_header`
+    std::string headerText; // the raw header, for `PlySchema`
+    std::vector<PlyElement> elements;
+    std::unordered_map<std::string, size_t> elementNames; // index of each element
+    std::vector<std::unordered_map<std::string, size_t>> propertyNames; // index of each property, per element
+    std::vector<std::shared_ptr<PlyData>> requestedData; // in request order, for `get_requests`
+    std::vector<std::string> comments;
+    std::vector<std::string> objInfo;
+    uint8_t scratch[8]; // one ascii value, before it is converted
+    std::vector<uint8_t> staging; // raw values of a list that is triangulated or converted
+
+    PlyReadOptions options;
+    PlyReadStats stats;
+
+    typedef std::chrono::steady_clock stats_clock;
+    static double elapsed_ms(const stats_clock::time_point since) { return std::chrono::duration<double, std::milli>(stats_clock::now() - since).count(); }
+
+    // Keeps the header stats and starts over for a load
+    void reset_read_stats()
+    {
+        PlyReadStats fresh;
+        fresh.header_ms = stats.header_ms;
+        fresh.header_bytes = stats.header_bytes;
+        fresh.elements.resize(elements.size());
+        for (size_t e = 0; e < elements.size(); ++e)
+        {
+            fresh.elements[e].name = elements[e].name;
+            fresh.elements[e].records = elements[e].size;
+        }
+        stats = fresh;
+    }
+
+    // Called by the decoders as they finish each element
+    void element_decoded(const size_t elementIndex, stats_clock::time_point& since)
+    {
+        const stats_clock::time_point now = stats_clock::now();
+        stats.elements[elementIndex].decode_ms += std::chrono::duration<double, std::milli>(now - since).count();
+        since = now;
+    }
+
+    void read(std::istream& is);
+    void read_mapped(const std::string& path);
+    std::future<void> read_async(const std::string& path);
+    void write(std::ostream& os, bool isBinary);
+
+    std::shared_ptr<PlyData> request_properties_from_element(const std::string& elementKey,
+        const std::vector<std::string>& propertyKeys,
+        const uint32_t list_size_hint, const Type type = Type::INVALID, const Layout layout = Layout::Interleaved);
+
+    std::shared_ptr<PlyData> request_columns(const std::string& elementKey, const std::vector<std::string>& propertyKeys, const Type type);
+
+    PlyTriangulatedFaces request_triangulated_faces(const std::string& elementKey, const std::string& propertyKey, const bool polygonOffsets);
+
+    void request_struct(const std::string& elementKey, const std::initializer_list<std::string> propertyKeys,
+        const Type* types, const size_t* offsets, const size_t numFields, const size_t stride,
+        std::shared_ptr<void> storage, uint8_t* (*resize)(void* storage, size_t count));
+
+    void request_batches(const std::string& elementKey, const std::vector<std::string>& propertyKeys,
+        const size_t batchSize, std::function<void(const PlyData&, size_t)> callback, const uint32_t list_size_hint, const Type type);
+
+    PlyGaussianSplats request_gaussian_splats(const std::string& elementKey, const bool activate);
+
+    void add_properties_to_element(const std::string& elementKey,
+        const std::initializer_list<std::string> propertyKeys,
+        const Type type, const size_t count, uint8_t* data, const Type listType, const size_t listCount);
+
+    Buffer allocate_buffer(const size_t bytes)
+    {
+        ++stats.allocations;
+        stats.bytes_allocated += bytes;
+        return options.allocator ? options.allocator->allocate(bytes) : Buffer(bytes);
+    }
+
+    // A buffer of |bytes| starting on an |alignment| boundary, carved out of a larger allocation
+    Buffer allocate_aligned_buffer(const size_t bytes, const size_t alignment)
+    {
+        auto block = std::make_shared<Buffer>(allocate_buffer(bytes + alignment - 1));
+        const uintptr_t address = reinterpret_cast<uintptr_t>(block->get());
+        uint8_t* aligned = block->get() + ((alignment - address % alignment) % alignment);
+        return Buffer(aligned, bytes, block);
+    }
+
+    // Groups holding lists are decoded without knowing their final size. Their buffer is the
+    // current chunk of an arena: when `bytes` don't fit at the cursor, the chunk is retired and a
+    // larger one started. `join_spilled_buffers` concatenates the chunks after the payload is read.
+    uint8_t* reserve_bytes(ParsingHelper& helper, const size_t bytes)
+    {
+        PlyDataCursor& cursor = *helper.cursor;
+        Buffer& buffer = helper.data->buffer;
+        if (cursor.byteOffset + bytes > buffer.size_bytes())
+        {
+            cursor.spilledBytes += cursor.byteOffset;
+            cursor.spilled.emplace_back(std::move(buffer), cursor.byteOffset);
+            buffer = allocate_buffer(std::max<size_t>({ bytes, cursor.spilledBytes, 4096 }));
+            cursor.byteOffset = 0;
+        }
+        return buffer.get() + cursor.byteOffset;
+    }
+
+    // Appends the triangles of one decoded polygon to a triangulated faces group
+    void append_polygon(ParsingHelper& helper, const Type t, const size_t stride, const uint8_t* indices, const size_t n);
+    void join_spilled(ParsingHelper& helper);
+    void join_spilled_buffers();
+    void scatter_struct(StructRequest& request);
+
+    // Batches of the element being decoded. Decoders report finished records with `end_records`,
+    // never more at once than fit the fullest batch (`records_until_batch`).
+    std::vector<BatchRequest*> batches_of(const size_t elementIndex)
+    {
+        std::vector<BatchRequest*> batches;
+        for (auto& batch : batchRequests) if (batch.element == elementIndex) batches.push_back(&batch);
+        return batches;
+    }
+
+    size_t records_until_batch(const std::vector<BatchRequest*>& batches, size_t records) const
+    {
+        for (auto* batch : batches) records = std::min(records, batch->helper->batchSize - batch->pending);
+        return records;
+    }
+
+    void end_records(const std::vector<BatchRequest*>& batches, const size_t records)
+    {
+        for (auto* batch : batches)
+        {
+            batch->pending += records;
+            if (batch->pending == batch->helper->batchSize) flush_batch(*batch);
+        }
+    }
+
+    void flush_batch(BatchRequest& batch);
+
+    size_t read_property_ascii(const Type& t, const size_t& stride, void* dest, size_t& destOffset, std::istream& is);
+
+    static PropertyLookup make_property_lookup(const PlyProperty& property, ParsingHelper* helper)
+    {
+        PropertyLookup f;
+        f.helper = helper;
+        f.skip = helper == nullptr;
+
+        f.prop_stride = PropertyTable[property.propertyType].stride;
+        if (property.isList) f.list_stride = PropertyTable[property.listType].stride;
+
+        f.dst_stride = f.prop_stride;
+        if (f.helper && f.helper->outputType != Type::INVALID)
+        {
+            f.dst_stride = PropertyTable[f.helper->outputType].stride;
+            f.convert = select_convert_kernel(property.propertyType, f.helper->outputType);
+        }
+        return f;
+    }
+
+    std::vector<std::vector<PropertyLookup>> make_property_lookup_table()
+    {
+        std::vector<std::vector<PropertyLookup>> element_property_lookup;
+
+        for (size_t e = 0; e < elements.size(); ++e)
+        {
+            const PlyElement& element = elements[e];
+            std::vector<PropertyLookup> lookups;
+
+            for (size_t p = 0; p < element.properties.size(); ++p)
+            {
+                const PlyProperty& property = element.properties[p];
+                auto cursorIt = userData.find(property_key(e, p));
+                const bool requested = cursorIt != userData.end() && !cursorIt->second.aliased;
+                lookups.push_back(make_property_lookup(property, requested ? &cursorIt->second : nullptr));
+            }
+
+            element_property_lookup.push_back(lookups);
+        }
+
+        return element_property_lookup;
+    }
+
+    // Name tables, rebuilt whenever elements or properties are added. A repeated name resolves
+    // to its first occurrence.
+    void index_names()
+    {
+        elementNames.clear();
+        propertyNames.clear();
+        for (size_t e = 0; e < elements.size(); ++e)
+        {
+            elementNames.emplace(elements[e].name, e);
+            std::unordered_map<std::string, size_t> names;
+            for (size_t p = 0; p < elements[e].properties.size(); ++p) names.emplace(elements[e].properties[p].name, p);
+            propertyNames.push_back(std::move(names));
+        }
+    }
+
+    int64_t find_element(const std::string& key) const
+    {
+        auto it = elementNames.find(key);
+        return it != elementNames.end() ? int64_t(it->second) : -1;
+    }
+
+    int64_t find_property(const size_t element, const std::string& key) const
+    {
+        auto it = propertyNames[element].find(key);
+        return it != propertyNames[element].end() ? int64_t(it->second) : -1;
+    }
+
+    bool parse_header(std::istream& is);
+    bool parse_header(std::istream& is, const PlySchema::State& schema);
+    void renew_requests();
+    PlyIndex index() const;
+    std::shared_ptr<PlyData> read_range(const std::string& path, const std::string& elementKey,
+        const std::initializer_list<std::string> propertyKeys, const size_t first, const size_t count, const Type type);
+    void parse_data(std::istream& is);
+    void parse_fixed_element_binary(const PlyElement& element, std::vector<PropertyLookup>& lookups, std::istream& is,
+        const std::vector<BatchRequest*>& batches, PlyReadStats* counted);
+    std::vector<DecodeOp> compile_element_binary(const PlyElement& element, const std::vector<PropertyLookup>& lookups);
+    void parse_element_binary(const PlyElement& element, const std::vector<PropertyLookup>& lookups, std::istream& is);
+    void skip_binary(std::istream& is, memory_streambuf* memory, const size_t bytes, const PlyElement& element);
+    void parse_data_ascii(std::istream& is);
+    bool parse_data_ascii_parallel(const char* begin, const char* end, unsigned int numThreads);
+    void read_header_format(std::istream& is);
+    void read_header_element(std::istream& is);
+    void read_header_property(std::istream& is);
+    void read_header_text(std::string line, std::istream& is, std::vector<std::string>& place, int erase = 0);
+
+    void write_header(std::ostream& os);
+    void write_ascii_internal(std::ostream& os);
+    void write_binary_internal(std::ostream& os);
+    void write_property_ascii(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset);
+    void write_property_binary(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset, const size_t& stride);
+};
+
+PlyProperty::PlyProperty(std::istream& is) : isList(false)
+{
+    std::string type;
+    is >> type;
+    if (type == "list")
+    {
+        std::string countType;
+        is >> countType >> type;
+        listType = property_type_from_string(countType);
+        isList = true;
+    }
+    propertyType = property_type_from_string(type);
+    is >> name;
+}
+
+PlyElement::PlyElement(std::istream& is)
+{
+    is >> name >> size;
+}
+
+template<typename T> inline T ply_read_ascii(std::istream& is)
+{
+    T data;
+    is >> data;
+    return data;
+}
+
+template<typename T> inline void endian_swap_one(uint8_t* p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    v = endian_swap<T, T>(v);
+    std::memcpy(p, &v, sizeof(T));
+}
+
+inline void endian_swap_one(uint8_t* p, const size_t width)
+{
+    switch (width)
+    {
+    case 2: endian_swap_one<uint16_t>(p); break;
+    case 4: endian_swap_one<uint32_t>(p); break;
+    case 8: endian_swap_one<uint64_t>(p); break;
+    default: break;
+    }
+}
+
+#if defined(TINYPLY_SSE2)
+// Byte-reverse every `Width`-byte lane of a 128-bit vector. With SSSE3 this is a single
+// pshufb; plain SSE2 swaps the 16-bit words within each lane first, then the bytes in each word.
+template<size_t Width> inline __m128i endian_swap_128(__m128i v)
+{
+#if defined(TINYPLY_SSSE3)
+    const __m128i mask = (Width == 2) ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) :
+                         (Width == 4) ? _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+                                        _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    return _mm_shuffle_epi8(v, mask);
+#else
+    if (Width == 4) v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+    if (Width == 8) v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B);
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+#endif
+}
+#endif
+
+template<size_t Width> inline void endian_swap_run(uint8_t* data, const size_t count)
+{
+    const size_t numBytes = count * Width;
+    size_t i = 0;
+#if defined(TINYPLY_AVX2)
+    const __m256i mask = (Width == 2) ? _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) :
+                         (Width == 4) ? _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+                                        _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    for (; i + 32 <= numBytes; i += 32)
+    {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+    }
+#endif
+#if defined(TINYPLY_SSE2)
+    for (; i + 16 <= numBytes; i += 16)
+    {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, endian_swap_128<Width>(_mm_loadu_si128(p)));
+    }
+#endif
+    for (; i < numBytes; i += Width) endian_swap_one(data + i, Width);
+}
+
+// Reverse the byte order of `count` contiguous values that are each `width` bytes wide
+inline void endian_swap_inplace(uint8_t* data, const size_t count, const size_t width)
+{
+    switch (width)
+    {
+    case 2: endian_swap_run<2>(data, count); break;
+    case 4: endian_swap_run<4>(data, count); break;
+    case 8: endian_swap_run<8>(data, count); break;
+    default: break;
+    }
+}
+
+// Same, for one field of `width` bytes repeated every `stride` bytes (mixed-width groups)
+inline void endian_swap_strided(uint8_t* data, const size_t count, const size_t width, const size_t stride)
+{
+    if (width < 2) return;
+    for (size_t i = 0; i < count; ++i, data += stride) endian_swap_one(data, width);
+}
+
+inline size_t list_count_from_bytes(const Type t, const uint8_t* raw)
+{
+    switch (t)
+    {
+    case Type::INT8:   { int8_t v;   std::memcpy(&v, raw, sizeof(v)); return static_cast<size_t>(v); }
+    case Type::UINT8:  { uint8_t v;  std::memcpy(&v, raw, sizeof(v)); return static_cast<size_t>(v); }
+    case Type::INT16:  { int16_t v;  std::memcpy(&v, raw, sizeof(v)); return static_cast<size_t>(v); }
+    case Type::UINT16: { uint16_t v; std::memcpy(&v, raw, sizeof(v)); return static_cast<size_t>(v); }
+    case Type::INT32:  { int32_t v;  std::memcpy(&v, raw, sizeof(v)); return static_cast<size_t>(v); }
+    case Type::UINT32: { uint32_t v; std::memcpy(&v, raw, sizeof(v)); return static_cast<size_t>(v); }
+    default: throw std::invalid_argument("invalid list count type");
+    }
+}
+
+inline size_t fan_triangulated_bytes(const size_t n) { return n < 3 ? 0 : (n - 2) * 3 * sizeof(uint32_t); }
+
+// Fan-triangulates a polygon of `n` integer indices of type `t`, `stride` bytes apart, into
+// three uint32 indices per triangle. Returns the bytes written to `dest`.
+inline size_t fan_triangulate(const Type t, const size_t stride, const uint8_t* src, const size_t n, uint8_t* dest)
+{
+    if (n < 3) return 0;
+    uint32_t triangle[3];
+    triangle[0] = static_cast<uint32_t>(list_count_from_bytes(t, src));
+    triangle[2] = static_cast<uint32_t>(list_count_from_bytes(t, src + stride));
+    for (size_t k = 2; k < n; ++k, dest += sizeof(triangle))
+    {
+        triangle[1] = triangle[2];
+        triangle[2] = static_cast<uint32_t>(list_count_from_bytes(t, src + k * stride));
+        std::memcpy(dest, triangle, sizeof(triangle));
+    }
+    return fan_triangulated_bytes(n);
+}
+
+template<typename T> void ply_cast_ascii(void* dest, std::istream& is)
+{
+    *(static_cast<T*>(dest)) = ply_read_ascii<T>(is);
+}
+
+bool PlyFile::PlyFileImpl::parse_header(std::istream& is)
+{
+    const stats_clock::time_point start = stats_clock::now();
+    std::string line;
+    headerBytes = 0;
+    headerText.clear();
+    while (std::getline(is, line))
+    {
+        headerBytes += line.size() + 1;
+        headerText += line;
+        headerText += '\n';
+        std::istringstream ls(line);
+        std::string token;
+        ls >> token;
+        if (token == "ply" || token == "PLY" || token == "") continue;
+        else if (token == "comment")    read_header_text(line, ls, comments, 8);
+        else if (token == "format")     read_header_format(ls);
+        else if (token == "element")    read_header_element(ls);
+        else if (token == "property")   read_header_property(ls);
+        else if (token == "obj_info")   read_header_text(line, ls, objInfo, 9);
+        else if (token == "end_header") break;
+        else return false; // unexpected header field
+    }
+    index_names();
+    stats = PlyReadStats();
+    stats.header_ms = elapsed_ms(start);
+    stats.header_bytes = headerBytes;
+    return true;
+}
+
+struct PlySchema::State
+{
+    std::string header;
+    PlyFile::PlyFileImpl prototype; // as after `parse_header` and the requests
+};
+
+PlySchema::PlySchema(const PlyFile& file)
+{
+    const PlyFile::PlyFileImpl& impl = *file.impl;
+    if (impl.headerText.empty()) throw std::invalid_argument("a schema needs a file with a parsed header");
+    if (!impl.structRequests.empty() || !impl.batchRequests.empty()) throw std::invalid_argument("struct, column and batch requests can't be kept in a schema");
+
+    std::shared_ptr<State> schema = std::make_shared<State>(State{ impl.headerText, impl });
+    schema->prototype.staging.clear();
+    schema->prototype.renew_requests();
+    state = schema;
+}
+
+bool PlyFile::PlyFileImpl::parse_header(std::istream& is, const PlySchema::State& schema)
+{
+    const stats_clock::time_point started = stats_clock::now();
+    const std::streampos start = is.tellg();
+    const std::string& header = schema.header;
+    char chunk[256];
+    bool same = true;
+    for (size_t at = 0; same && at < header.size(); at += sizeof(chunk))
+    {
+        const size_t n = std::min(sizeof(chunk), header.size() - at);
+        same = is.read(chunk, std::streamsize(n)) && std::memcmp(chunk, header.data() + at, n) == 0;
+    }
+
+    if (!same)
+    {
+        is.clear();
+        if (start == std::streampos(-1) || !is.seekg(start)) throw std::runtime_error("header differs from the schema and the stream can't be rewound");
+        return false;
+    }
+
+    *this = schema.prototype;
+    renew_requests();
+    stats = PlyReadStats();
+    stats.header_ms = elapsed_ms(started);
+    stats.header_bytes = headerBytes;
+    return true;
+}
+
+// Gives every request group a new PlyData and cursor, as they were when the requests were made
+void PlyFile::PlyFileImpl::renew_requests()
+{
+    std::unordered_map<PlyData*, std::shared_ptr<PlyData>> renewed;
+    auto renew = [&](const std::shared_ptr<PlyData>& old, const size_t count)
+    {
+        std::shared_ptr<PlyData>& data = renewed[old.get()];
+        if (!data)
+        {
+            data = std::make_shared<PlyData>();
+            data->t = old->t;
+            data->isList = old->isList;
+            data->count = count;
+        }
+        return data;
+    };
+
+    std::unordered_map<PlyDataCursor*, std::shared_ptr<PlyDataCursor>> cursors;
+    for (size_t e = 0; e < elements.size(); ++e)
+    {
+        for (size_t p = 0; p < elements[e].properties.size(); ++p)
+        {
+            auto it = userData.find(property_key(e, p));
+            if (it == userData.end()) continue;
+            ParsingHelper& helper = it->second;
+            helper.data = renew(helper.data, elements[e].size);
+            if (helper.polygonOffsets) helper.polygonOffsets = renew(helper.polygonOffsets, elements[e].size + 1);
+            std::shared_ptr<PlyDataCursor>& cursor = cursors[helper.cursor.get()];
+            if (!cursor) cursor = std::make_shared<PlyDataCursor>();
+            helper.cursor = cursor;
+            helper.aliased = false;
+        }
+    }
+    for (auto& data : requestedData) data = renewed[data.get()];
+}
+
+PlyIndex PlyFile::PlyFileImpl::index() const
+{
+    PlyIndex index;
+    index.binary = isBinary;
+    index.big_endian = isBigEndian;
+    index.header_bytes = headerBytes;
+
+    uint64_t offset = headerBytes;
+    bool located = isBinary;
+    for (auto& element : elements)
+    {
+        PlyElementIndex entry;
+        entry.name = element.name;
+        entry.count = element.size;
+        const bool fixedSize = isBinary && std::none_of(element.properties.begin(), element.properties.end(), [](const PlyProperty& p) { return p.isList; });
+        if (fixedSize) for (auto& property : element.properties) entry.record_bytes += PropertyTable[property.propertyType].stride;
+        entry.located = located;
+        entry.offset = located ? offset : 0;
+        entry.length = located ? uint64_t(entry.record_bytes) * element.size : 0;
+
+        // Past a variable-length element nothing is known without reading the payload
+        if (!fixedSize && element.size > 0) located = false;
+        offset += entry.length;
+        index.elements.push_back(entry);
+    }
+    return index;
+}
+
+void PlyFile::PlyFileImpl::read_header_text(std::string line, std::istream& is, std::vector<std::string>& place, int erase)
+{
+    place.push_back((erase > 0) ? line.erase(0, erase) : line);
+}
+
+void PlyFile::PlyFileImpl::read_header_format(std::istream& is)
+{
+    std::string s;
+    (is >> s);
+    if (s == "binary_little_endian") isBinary = true;
+    else if (s == "binary_big_endian") isBinary = isBigEndian = true;
+}
+
+void PlyFile::PlyFileImpl::read_header_element(std::istream& is)
+{
+    elements.emplace_back(is);
+}
+
+void PlyFile::PlyFileImpl::read_header_property(std::istream& is)
 {
     if (!elements.size()) throw std::runtime_error("no elements defined; file is malformed");
     elements.back().properties.emplace_back(is);
 }
 
-size_t PlyFile::PlyFileImpl::read_property_binary(const Type& t, const size_t& stride, void* dest, size_t& destOffset, std::istream& is)
-{
-    destOffset += stride;
-    is.read((char*)dest, stride);
-    return stride;
+size_t PlyFile::PlyFileImpl::read_property_ascii(const Type& t, const size_t& stride, void* dest, size_t& destOffset, std::istream& is)
+{
+    destOffset += stride;
+    switch (t)
+    {
+    case Type::INT8:       *((int8_t*)dest) = ply_read_ascii<int32_t>(is);  break;
+    case Type::UINT8:      *((uint8_t*)dest) = ply_read_ascii<uint32_t>(is); break;
+    case Type::INT16:      ply_cast_ascii<int16_t>(dest, is);                 break;
+    case Type::UINT16:     ply_cast_ascii<uint16_t>(dest, is);                break;
+    case Type::INT32:      ply_cast_ascii<int32_t>(dest, is);                 break;
+    case Type::UINT32:     ply_cast_ascii<uint32_t>(dest, is);                break;
+    case Type::FLOAT32:    ply_cast_ascii<float>(dest, is);                   break;
+    case Type::FLOAT64:    ply_cast_ascii<double>(dest, is);                  break;
+    case Type::INVALID:    throw std::invalid_argument("invalid ply property");
+    }
+    return stride;
+}
+
+void PlyFile::PlyFileImpl::write_property_ascii(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset)
+{
+    switch (t)
+    {
+    case Type::INT8:       os << static_cast<int32_t>(*reinterpret_cast<int8_t*>(src));   break;
+    case Type::UINT8:      os << static_cast<uint32_t>(*reinterpret_cast<uint8_t*>(src)); break;
+    case Type::INT16:      os << *reinterpret_cast<int16_t*>(src);  break;
+    case Type::UINT16:     os << *reinterpret_cast<uint16_t*>(src); break;
+    case Type::INT32:      os << *reinterpret_cast<int32_t*>(src);  break;
+    case Type::UINT32:     os << *reinterpret_cast<uint32_t*>(src); break;
+    case Type::FLOAT32:    os << *reinterpret_cast<float*>(src);    break;
+    case Type::FLOAT64:    os << *reinterpret_cast<double*>(src);   break;
+    case Type::INVALID:    throw std::invalid_argument("invalid ply property");
+    }
+    os << " ";
+    srcOffset += PropertyTable[t].stride;
+}
+
+void PlyFile::PlyFileImpl::write_property_binary(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset, const size_t& stride)
+{
+    os.write((char*)src, stride);
+    srcOffset += stride;
+}
+
+void PlyFile::PlyFileImpl::read(std::istream& is)
+{
+    // Parallel ascii decoding needs the payload in memory
+    if (!isBinary && options.fast_ascii && options.num_threads != 1 && batchRequests.empty() && !dynamic_cast<memory_streambuf*>(is.rdbuf()))
+    {
+        const stats_clock::time_point start = stats_clock::now();
+        std::vector<char> payload;
+        for (size_t got = 0; is; )
+        {
+            payload.resize(got + options.block_size_bytes);
+            is.read(payload.data() + got, std::streamsize(options.block_size_bytes));
+            ++stats.read_calls;
+            got += size_t(is.gcount());
+            payload.resize(got);
+        }
+        stats.decode_ms += elapsed_ms(start);
+        memory_streambuf buffer(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+        std::istream memory(&buffer);
+        return read(memory);
+    }
+
+    stats_clock::time_point phase = stats_clock::now();
+    for (auto& entry : userData)
+    {
+        if (entry.second.aliased) continue;
+        PlyElementReadStats& element = stats.elements[size_t(entry.first >> 32)];
+        if (!element.requested) stats.records_decoded += element.records;
+        element.requested = true;
+    }
+
+    // Struct requests on elements that take the bulk binary path are decoded in place; the others
+    // are decoded into a packed group like any other and scattered into the structs afterwards
+    for (auto& request : structRequests)
+    {
+        if (request.columns)
+        {
+            auto columns = std::make_shared<Buffer>(allocate_aligned_buffer(request.bytes, 64));
+            request.storage = columns->get();
+            request.owner = columns;
+        }
+        const PlyElement& element = elements[request.element];
+        const bool fixedSize = std::none_of(element.properties.begin(), element.properties.end(), [](const PlyProperty& p) { return p.isList; });
+        request.direct = isBinary && fixedSize && options.bulk_binary && request.storage != nullptr;
+        if (request.direct) request.data->buffer = Buffer(request.storage, request.bytes, request.owner);
+    }
+
+    // Size each group from the header, assuming list lengths from the hints. Properties of a group
+    // share one buffer, with one record after the other.
+    std::unordered_map<PlyData*, size_t> bytesPerRecord;
+    for (size_t e = 0; e < elements.size(); ++e)
+    {
+        for (size_t p = 0; p < elements[e].properties.size(); ++p)
+        {
+            const PlyProperty& property = elements[e].properties[p];
+            auto it = userData.find(property_key(e, p));
+            if (it == userData.end() || it->second.aliased) continue;
+            const uint32_t hint = it->second.list_size_hint ? it->second.list_size_hint : 3;
+            const size_t stride = PropertyTable[it->second.outputType != Type::INVALID ? it->second.outputType : property.propertyType].stride;
+            if (it->second.triangulate) bytesPerRecord[it->second.data.get()] += fan_triangulated_bytes(hint);
+            else bytesPerRecord[it->second.data.get()] += stride * (property.isList ? hint : 1);
+        }
+    }
+
+    for (auto& entry : userData)
+    {
+        PlyData& data = *entry.second.data;
+        const size_t records = entry.second.batchSize ? std::min(data.count, entry.second.batchSize) : data.count;
+        if (!entry.second.aliased && data.buffer.get() == nullptr) data.buffer = allocate_buffer(records * bytesPerRecord[&data]);
+
+        PlyData* offsets = entry.second.polygonOffsets.get();
+        if (offsets && offsets->buffer.get() == nullptr) offsets->buffer = allocate_buffer(offsets->count * sizeof(uint32_t));
+    }
+
+    // Splat arrays are filled in by the batch callbacks, which only scatter into them
+    for (auto& array : splatArrays)
+    {
+        if (array.first->buffer.get() == nullptr) array.first->buffer = allocate_aligned_buffer(array.first->count * array.second * sizeof(float), 64);
+    }
+
+    stats.allocate_ms += elapsed_ms(phase);
+
+    // Populate the data in a single pass. Big endian values are swapped as they are decoded, while still in cache.
+    phase = stats_clock::now();
+    parse_data(is);
+    stats.decode_ms += elapsed_ms(phase);
+
+    phase = stats_clock::now();
+    for (auto& batch : batchRequests) flush_batch(batch);
+    join_spilled_buffers();
+    for (auto& request : structRequests) if (!request.direct) scatter_struct(request);
+
+    // The number of triangles is only known once the faces are decoded
+    for (auto& entry : userData)
+    {
+        ParsingHelper& helper = entry.second;
+        if (!helper.triangulate) continue;
+        helper.data->count = helper.cursor->byteOffset / (3 * sizeof(uint32_t));
+        if (helper.polygonOffsets)
+        {
+            const uint32_t numTriangles = static_cast<uint32_t>(helper.data->count);
+            std::memcpy(helper.polygonOffsets->buffer.get() + helper.cursor->numPolygons * sizeof(uint32_t), &numTriangles, sizeof(uint32_t));
+        }
+    }
+    stats.finish_ms += elapsed_ms(phase);
+}
+
+void PlyFile::PlyFileImpl::append_polygon(ParsingHelper& helper, const Type t, const size_t stride, const uint8_t* indices, const size_t n)
+{
+    PlyDataCursor& cursor = *helper.cursor;
+    if (helper.polygonOffsets)
+    {
+        const uint32_t firstTriangle = static_cast<uint32_t>((cursor.spilledBytes + cursor.byteOffset) / (3 * sizeof(uint32_t)));
+        std::memcpy(helper.polygonOffsets->buffer.get() + cursor.numPolygons * sizeof(uint32_t), &firstTriangle, sizeof(uint32_t));
+    }
+    cursor.numPolygons++;
+    uint8_t* dest = reserve_bytes(helper, fan_triangulated_bytes(n));
+    cursor.byteOffset += fan_triangulate(t, stride, indices, n, dest);
+}
+
+void PlyFile::PlyFileImpl::join_spilled(ParsingHelper& helper)
+{
+    PlyDataCursor& cursor = *helper.cursor;
+    if (cursor.spilled.empty()) return;
+
+    Buffer joined = allocate_buffer(cursor.spilledBytes + cursor.byteOffset);
+    size_t offset = 0;
+    for (auto& chunk : cursor.spilled)
+    {
+        std::memcpy(joined.get() + offset, chunk.first.get(), chunk.second);
+        offset += chunk.second;
+    }
+    std::memcpy(joined.get() + offset, helper.data->buffer.get(), cursor.byteOffset);
+    cursor.byteOffset += offset;
+    cursor.spilled.clear();
+    cursor.spilledBytes = 0;
+    helper.data->buffer = std::move(joined);
+}
+
+void PlyFile::PlyFileImpl::join_spilled_buffers()
+{
+    for (auto& entry : userData)
+    {
+        ParsingHelper& helper = entry.second;
+        if (helper.aliased) continue;
+        join_spilled(helper);
+
+        // Lists shorter than the hint leave unused capacity at the end
+        helper.data->buffer.shrink_to(helper.cursor->byteOffset);
+    }
+}
+
+void PlyFile::PlyFileImpl::flush_batch(BatchRequest& batch)
+{
+    if (batch.pending == 0) return;
+
+    // Lists longer than the hint may have spilled; a batch is handed over as one buffer, which
+    // then stays large enough for the batches that follow
+    ParsingHelper& helper = *batch.helper;
+    join_spilled(helper);
+
+    PlyData view;
+    view.t = helper.data->t;
+    view.isList = helper.data->isList;
+    view.count = batch.pending;
+    view.buffer = Buffer(helper.data->buffer.get(), helper.cursor->byteOffset, nullptr);
+    batch.callback(view, batch.first);
+
+    batch.first += batch.pending;
+    batch.pending = 0;
+    helper.cursor->byteOffset = 0;
+}
+
+void PlyFile::PlyFileImpl::scatter_struct(StructRequest& request)
+{
+    // The packed group holds the requested properties in file order, at their output widths
+    const PlyElement& element = elements[request.element];
+    std::vector<std::pair<size_t, ParsingHelper*>> fields;
+    size_t packedStride = 0;
+    for (size_t p = 0; p < element.properties.size(); ++p)
+    {
+        auto it = userData.find(property_key(request.element, p));
+        if (it == userData.end() || it->second.data != request.data) continue;
+        fields.emplace_back(packedStride, &it->second);
+        packedStride += PropertyTable[it->second.outputType].stride;
+    }
+
+    const size_t count = request.data->count;
+    uint8_t* packed = request.data->buffer.get();
+    for (const auto& field : fields)
+    {
+        const size_t width = PropertyTable[field.second->outputType].stride;
+        uint8_t* dst = request.storage + field.second->structOffset;
+        if (deinterleave_fn kernel = select_deinterleave_kernel(width, packedStride, request.stride)) kernel(dst, request.stride, packed + field.first, packedStride, count);
+        else deinterleave_any(dst, request.stride, packed + field.first, packedStride, count, width);
+    }
+    request.data->buffer = Buffer(request.storage, request.bytes, request.owner);
+}
+
+void PlyFile::PlyFileImpl::read_mapped(const std::string& path)
+{
+    if (elements.empty()) throw std::runtime_error("header must be parsed before calling read_mapped");
+
+    const stats_clock::time_point start = stats_clock::now();
+    std::shared_ptr<PlyMappedFile> mapping = std::make_shared<PlyMappedFile>(path);
+    const uint8_t* const mapBegin = mapping->data();
+    const uint8_t* const mapEnd = mapBegin + mapping->size();
+
+    // The payload starts right after the header that was parsed from the same file
+    const PlyIndex layout = index();
+    if (layout.header_bytes > mapping->size()) throw std::runtime_error("mapped file is shorter than its header: " + path);
+    const uint8_t* payload = mapBegin + layout.header_bytes;
+
+    // Alias groups that cover a whole list-free element. In that case the packed PlyData layout
+    // (properties in header order, one record after the other) is exactly the file layout. This
+    // requires knowing where the element starts, so stop at the first element the index can't locate.
+    if (isBinary && !isBigEndian)
+    {
+        for (size_t i = 0; i < elements.size(); ++i)
+        {
+            const PlyElement& element = elements[i];
+            const PlyElementIndex& extent = layout.elements[i];
+            if (!extent.located || extent.record_bytes == 0) break;
+
+            const size_t elementBytes = size_t(extent.length);
+            if (elementBytes == 0 || extent.offset + extent.length > mapping->size()) break;
+
+            std::vector<ParsingHelper*> helpers;
+            bool converted = false;
+            for (size_t p = 0; p < element.properties.size(); ++p)
+            {
+                const PlyProperty& property = element.properties[p];
+                auto it = userData.find(property_key(i, p));
+                if (it == userData.end()) continue;
+                helpers.push_back(&it->second);
+                converted |= select_convert_kernel(property.propertyType, it->second.outputType) != nullptr;
+            }
+
+            const bool wholeElement = !converted && helpers.size() == element.properties.size() && helpers.front()->structStride == 0 && helpers.front()->batchSize == 0 &&
+                std::all_of(helpers.begin(), helpers.end(), [&](ParsingHelper* h) { return h->data == helpers.front()->data; });
+
+            if (wholeElement)
+            {
+                uint8_t* src = const_cast<uint8_t*>(mapBegin) + extent.offset;
+                helpers.front()->data->buffer = Buffer(src, elementBytes, mapping);
+                for (auto* h : helpers) h->aliased = true;
+                stats.elements[i].requested = true;
+            }
+        }
+    }
+
+    bool anyToDecode = false;
+    for (auto& entry : userData) anyToDecode |= !entry.second.aliased;
+    stats.map_ms += elapsed_ms(start);
+    if (!anyToDecode) return;
+
+    memory_streambuf buffer(payload, size_t(mapEnd - payload));
+    std::istream is(&buffer);
+    read(is);
+}
+
+std::future<void> PlyFile::PlyFileImpl::read_async(const std::string& path)
+{
+    if (elements.empty()) throw std::runtime_error("header must be parsed before calling read_async");
+
+    return std::async(std::launch::async, [this, path]()
+    {
+        prefetch_streambuf buffer(path, headerBytes, std::max<size_t>(options.async_buffer_bytes, 4096), std::max(options.async_buffers, 2u));
+        std::istream is(&buffer);
+        try
+        {
+            read(is);
+        }
+        catch (...)
+        {
+            // A failed disk read looks like a short file to the decoder; report the real cause
+            if (std::exception_ptr error = buffer.io_error()) std::rethrow_exception(error);
+            throw;
+        }
+    });
+}
+
+std::shared_ptr<PlyData> PlyFile::PlyFileImpl::read_range(const std::string& path, const std::string& elementKey,
+    const std::initializer_list<std::string> propertyKeys, const size_t first, const size_t count, const Type type)
+{
+    if (elements.empty()) throw std::runtime_error("header must be parsed before calling read_range");
+    if (!isBinary) throw std::runtime_error("read_range requires a binary file");
+    if (!propertyKeys.size()) throw std::invalid_argument("`propertyKeys` argument is empty");
+
+    const int64_t elementIndex = find_element(elementKey);
+    if (elementIndex < 0) throw std::invalid_argument("the element key was not found in the header: " + elementKey);
+    const PlyElement& element = elements[elementIndex];
+
+    const PlyElementIndex extent = index().elements[elementIndex];
+    if (!extent.located || extent.record_bytes == 0) throw std::invalid_argument("element has no fixed file offset (it or an element before it holds lists): " + elementKey);
+    if (first > element.size || count > element.size - first) throw std::invalid_argument("range is outside of element " + elementKey);
+
+    std::vector<std::string> keys_not_found;
+    for (auto& key : propertyKeys) if (find_property(size_t(elementIndex), key) < 0) keys_not_found.push_back(key);
+    if (keys_not_found.size())
+    {
+        std::stringstream ss;
+        for (auto& str : keys_not_found) ss << str << ", ";
+        throw std::invalid_argument("the following property keys were not found in the header: " + ss.str());
+    }
+
+    // A private group, so this touches nothing that `read` or other ranges use
+    ParsingHelper helper;
+    helper.data = std::make_shared<PlyData>();
+    helper.data->count = count;
+    helper.data->isList = false;
+    helper.cursor = std::make_shared<PlyDataCursor>();
+    helper.list_size_hint = 0;
+    helper.outputType = type;
+
+    std::vector<bool> requested(element.properties.size(), false);
+    for (auto& key : propertyKeys)
+    {
+        const size_t propertyIndex = size_t(find_property(size_t(elementIndex), key));
+        if (requested[propertyIndex]) throw std::invalid_argument("element-property key has already been requested: " + element.name + " " + key);
+        requested[propertyIndex] = true;
+        helper.data->t = (type != Type::INVALID) ? type : element.properties[propertyIndex].propertyType;
+    }
+
+    std::vector<PropertyLookup> lookups;
+    size_t dstRecordBytes = 0;
+    bool converted = false;
+    for (size_t i = 0; i < element.properties.size(); ++i)
+    {
+        lookups.push_back(make_property_lookup(element.properties[i], requested[i] ? &helper : nullptr));
+        if (requested[i]) dstRecordBytes += lookups.back().dst_stride;
+        converted |= lookups.back().convert != nullptr;
+    }
+
+    helper.data->buffer = Buffer(count * dstRecordBytes);
+    if (count == 0) return helper.data;
+
+    PlyRandomAccessFile file(path);
+    const size_t srcBytes = count * extent.record_bytes;
+    const uint64_t offset = extent.offset + uint64_t(first) * extent.record_bytes;
+
+    // Whole records in file order and type: the file bytes are the result
+    if (!converted && !isBigEndian && dstRecordBytes == extent.record_bytes)
+    {
+        file.read(helper.data->buffer.get(), srcBytes, offset);
+        return helper.data;
+    }
+
+    std::vector<uint8_t> records(srcBytes);
+    file.read(records.data(), srcBytes, offset);
+    memory_streambuf buffer(records.data(), records.size());
+    std::istream is(&buffer);
+
+    PlyElement range = element;
+    range.size = count;
+    parse_fixed_element_binary(range, lookups, is, {}, nullptr);
+    return helper.data;
+}
+
+void PlyFile::PlyFileImpl::write(std::ostream& os, bool _isBinary)
+{
+    // reset cursors
+    for (auto& d : userData) { d.second.cursor->byteOffset = 0; }
+    if (_isBinary) write_binary_internal(os);
+    else write_ascii_internal(os);
+}
+
+void PlyFile::PlyFileImpl::write_binary_internal(std::ostream& os)
+{
+    isBinary = true;
+    write_header(os);
+
+    uint8_t listSize[4] = { 0, 0, 0, 0 };
+    size_t dummyCount = 0;
+
+    auto element_property_lookup = make_property_lookup_table();
+
+    size_t element_idx = 0;
+    for (auto& e : elements)
+    {
+        for (size_t i = 0; i < e.size; ++i)
+        {
+            size_t property_index = 0;
+            for (auto& p : e.properties)
+            {
+                auto& f = element_property_lookup[element_idx][property_index];
+                auto* helper = f.helper;
+
+                if (p.isList)
+                {
+                    std::memcpy(listSize, &p.listCount, sizeof(uint32_t));
+                    write_property_binary(p.listType, os, listSize, dummyCount, f.list_stride);
+                    write_property_binary(p.propertyType, os, (helper->data->buffer.get() + helper->cursor->byteOffset), helper->cursor->byteOffset, f.prop_stride * p.listCount);
+                }
+                else
+                {
+                    write_property_binary(p.propertyType, os, (helper->data->buffer.get() + helper->cursor->byteOffset), helper->cursor->byteOffset, f.prop_stride);
+                }
+                property_index++;
+            }
+        }
+        element_idx++;
+    }
+}
+
+void PlyFile::PlyFileImpl::write_ascii_internal(std::ostream& os)
+{
+    write_header(os);
+
+    for (size_t ei = 0; ei < elements.size(); ++ei)
+    {
+        const PlyElement& e = elements[ei];
+        for (size_t i = 0; i < e.size; ++i)
+        {
+            for (size_t pi = 0; pi < e.properties.size(); ++pi)
+            {
+                const PlyProperty& p = e.properties[pi];
+                auto& helper = userData[property_key(ei, pi)];
+                if (p.isList)
+                {
+                    os << p.listCount << " ";
+                    for (size_t j = 0; j < p.listCount; ++j)
+                    {
+                        write_property_ascii(p.propertyType, os, (helper.data->buffer.get() + helper.cursor->byteOffset), helper.cursor->byteOffset);
+                    }
+                }
+                else
+                {
+                    write_property_ascii(p.propertyType, os, (helper.data->buffer.get() + helper.cursor->byteOffset), helper.cursor->byteOffset);
+                }
+            }
+            os << "\n";
+        }
+    }
+}
+
+void PlyFile::PlyFileImpl::write_header(std::ostream& os)
+{
+    const std::locale& fixLoc = std::locale("C");
+    os.imbue(fixLoc);
+
+    os << "ply\n";
+    if (isBinary) os << ((isBigEndian) ? "format binary_big_endian 1.0" : "format binary_little_endian 1.0") << "\n";
+    else os << "format ascii 1.0\n";
+
+    for (const auto& comment : comments) os << "comment " << comment << "\n";
+
+    for (auto& e : elements)
+    {
+        os << "element " << e.name << " " << e.size << "\n";
+        for (const auto& p : e.properties)
+        {
+            if (p.isList)
+            {
+                os << "property list " << PropertyTable[p.listType].str << " "
+                    << PropertyTable[p.propertyType].str << " " << p.name << "\n";
+            }
+            else
+            {
+                os << "property " << PropertyTable[p.propertyType].str << " " << p.name << "\n";
+            }
+        }
+    }
+    os << "end_header\n";
+}
+
+std::shared_ptr<PlyData> PlyFile::PlyFileImpl::request_properties_from_element(const std::string& elementKey,
+    const std::vector<std::string>& propertyKeys,
+    const uint32_t list_size_hint, const Type type, const Layout layout)
+{
+    if (layout == Layout::Columns) return request_columns(elementKey, propertyKeys, type);
+
+    // Each key in `propertyKey` gets an entry into the userData map (keyed by the element and
+    // property indices, see `property_key`), but groups of properties (requested from the
+    // public api through this function) all share the same `ParsingHelper`. When it comes 
+    // time to .read(), we check the number of unique PlyData shared pointers
+    // and allocate a single buffer that will be used by each individual property. 
+    ParsingHelper helper;
+    helper.data = std::make_shared<PlyData>();
+    helper.data->count = 0;
+    helper.data->isList = false;
+    helper.data->t = Type::INVALID;
+    helper.cursor = std::make_shared<PlyDataCursor>();
+    helper.list_size_hint = list_size_hint;
+    helper.outputType = type;
+
+    if (elements.empty()) throw std::runtime_error("header had no elements defined. malformed file?");
+    if (elementKey.empty()) throw std::invalid_argument("`elementKey` argument is empty");
+    if (!propertyKeys.size()) throw std::invalid_argument("`propertyKeys` argument is empty");
+
+    const int64_t elementIndex = find_element(elementKey);
+
+    std::vector<std::string> keys_not_found;
+
+    // Sanity check if the user requested element is in the pre-parsed header
+    if (elementIndex >= 0)
+    {
+        // We found the element
+        const PlyElement& element = elements[elementIndex];
+
+        helper.data->count = element.size;
+
+        // Find each of the keys
+        std::vector<size_t> propertyIndices;
+        for (auto key : propertyKeys)
+        {
+            const int64_t propertyIndex = find_property(size_t(elementIndex), key);
+            // The key was not found
+            if (propertyIndex < 0)
+            {
+                keys_not_found.push_back(key);
+            }
+            else propertyIndices.push_back(size_t(propertyIndex));
+        }
+
+        if (keys_not_found.size())
+        {
+            std::stringstream ss;
+            for (auto& str : keys_not_found) ss << str << ", ";
+            throw std::invalid_argument("the following property keys were not found in the header: " + ss.str());
+        }
+
+        for (const size_t propertyIndex : propertyIndices)
+        {
+            const PlyProperty& property = element.properties[propertyIndex];
+            helper.data->t = (type != Type::INVALID) ? type : property.propertyType;
+            helper.data->isList = property.isList;
+            auto result = userData.insert(std::pair<uint64_t, ParsingHelper>(property_key(size_t(elementIndex), propertyIndex), helper));
+            if (result.second == false)
+            {
+                throw std::invalid_argument("element-property key has already been requested: " + element.name + " " + property.name);
+            }
+        }
+    }
+    else throw std::invalid_argument("the element key was not found in the header: " + elementKey);
+
+    if (keys_not_found.size())
+    {
+        std::stringstream ss;
+        for (auto& str : keys_not_found) ss << str << ", ";
+        throw std::invalid_argument("the following property keys were not found in the header: " + ss.str());
+    }
+    requestedData.push_back(helper.data);
+    return helper.data;
 }
 
-size_t PlyFile::PlyFileImpl::read_property_ascii(const Type& t, const size_t& stride, void* dest, size_t& destOffset, std::istream& is)
+void PlyFile::PlyFileImpl::request_struct(const std::string& elementKey, const std::initializer_list<std::string> propertyKeys,
+    const Type* types, const size_t* offsets, const size_t numFields, const size_t stride,
+    std::shared_ptr<void> storage, uint8_t* (*resize)(void* storage, size_t count))
 {
-    destOffset += stride;
-    switch (t)
+    if (propertyKeys.size() != numFields) throw std::invalid_argument("`propertyKeys` must name one property per field of the requested struct");
+
+    const int64_t elementIndex = find_element(elementKey);
+    if (elementIndex >= 0)
     {
-    case Type::INT8:       *((int8_t*)dest) = ply_read_ascii<int32_t>(is);  break;
-    case Type::UINT8:      *((uint8_t*)dest) = ply_read_ascii<uint32_t>(is); break;
-    case Type::INT16:      ply_cast_ascii<int16_t>(dest, is);                 break;
-    case Type::UINT16:     ply_cast_ascii<uint16_t>(dest, is);                break;
-    case Type::INT32:      ply_cast_ascii<int32_t>(dest, is);                 break;
-    case Type::UINT32:     ply_cast_ascii<uint32_t>(dest, is);                break;
-    case Type::FLOAT32:    ply_cast_ascii<float>(dest, is);                   break;
-    case Type::FLOAT64:    ply_cast_ascii<double>(dest, is);                  break;
-    case Type::INVALID:    throw std::invalid_argument("invalid ply property");
+        const PlyElement& element = elements[elementIndex];
+        for (auto key : propertyKeys)
+        {
+            const int64_t propertyIndex = find_property(size_t(elementIndex), key);
+            if (propertyIndex >= 0 && element.properties[propertyIndex].isList)
+                throw std::invalid_argument("list properties cannot be requested as struct fields: " + elementKey + " " + key);
+        }
     }
-    return stride;
+
+    // Errors for unknown or already requested keys are reported as for any other request
+    StructRequest request;
+    request.data = request_properties_from_element(elementKey, propertyKeys, 0);
+    request.data->t = Type::INVALID; // mixed; the layout is T's
+    request.element = size_t(elementIndex);
+    request.stride = stride;
+    request.bytes = request.data->count * stride;
+    request.storage = resize(storage.get(), request.data->count);
+    request.owner = storage;
+
+    size_t i = 0;
+    for (auto key : propertyKeys)
+    {
+        ParsingHelper& helper = userData[property_key(request.element, size_t(find_property(request.element, key)))];
+        helper.outputType = types[i];
+        helper.structOffset = offsets[i++];
+        helper.structStride = stride;
+    }
+    structRequests.push_back(request);
 }
 
-void PlyFile::PlyFileImpl::write_property_ascii(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset)
+std::shared_ptr<PlyData> PlyFile::PlyFileImpl::request_columns(const std::string& elementKey, const std::vector<std::string>& propertyKeys, const Type type)
 {
-    switch (t)
+    // Columns share one type, and the width of a value is the stride of their records
+    const int64_t elementIndex = find_element(elementKey);
+    Type columnType = type;
+    if (elementIndex >= 0)
     {
-    case Type::INT8:       os << static_cast<int32_t>(*reinterpret_cast<int8_t*>(src));   break;
-    case Type::UINT8:      os << static_cast<uint32_t>(*reinterpret_cast<uint8_t*>(src)); break;
-    case Type::INT16:      os << *reinterpret_cast<int16_t*>(src);  break;
-    case Type::UINT16:     os << *reinterpret_cast<uint16_t*>(src); break;
-    case Type::INT32:      os << *reinterpret_cast<int32_t*>(src);  break;
-    case Type::UINT32:     os << *reinterpret_cast<uint32_t*>(src); break;
-    case Type::FLOAT32:    os << *reinterpret_cast<float*>(src);    break;
-    case Type::FLOAT64:    os << *reinterpret_cast<double*>(src);   break;
-    case Type::INVALID:    throw std::invalid_argument("invalid ply property");
+        const PlyElement& element = elements[elementIndex];
+        for (auto& key : propertyKeys)
+        {
+            const int64_t propertyIndex = find_property(size_t(elementIndex), key);
+            if (propertyIndex < 0) continue;
+            const PlyProperty& property = element.properties[propertyIndex];
+            if (property.isList) throw std::invalid_argument("list properties cannot be requested as columns: " + elementKey + " " + key);
+            if (columnType == Type::INVALID) columnType = property.propertyType;
+            if (type == Type::INVALID && property.propertyType != columnType)
+                throw std::invalid_argument("columns must share a type; pass one to convert them to: " + elementKey + " " + key);
+        }
     }
-    os << " ";
-    srcOffset += PropertyTable[t].stride;
+    const size_t width = PropertyTable[columnType].stride;
+
+    // Errors for unknown or already requested keys are reported as for any other request
+    StructRequest request;
+    request.data = request_properties_from_element(elementKey, propertyKeys, 0, type);
+    request.data->columnStride = (request.data->count * width + 63) / 64 * 64;
+    request.element = size_t(elementIndex);
+    request.stride = width;
+    request.bytes = propertyKeys.size() * request.data->columnStride;
+    request.storage = nullptr; // allocated by `read`
+    request.columns = true;
+
+    size_t column = 0;
+    for (auto& key : propertyKeys)
+    {
+        const int64_t propertyIndex = find_property(request.element, key);
+        ParsingHelper& helper = userData[property_key(request.element, size_t(propertyIndex))];
+        helper.outputType = columnType;
+        helper.structOffset = column++ * request.data->columnStride;
+        helper.structStride = width;
+    }
+    structRequests.push_back(request);
+    return request.data;
 }
 
-void PlyFile::PlyFileImpl::write_property_binary(Type t, std::ostream& os, uint8_t* src, size_t& srcOffset, const size_t& stride)
+void PlyFile::PlyFileImpl::request_batches(const std::string& elementKey, const std::vector<std::string>& propertyKeys,
+    const size_t batchSize, std::function<void(const PlyData&, size_t)> callback, const uint32_t list_size_hint, const Type type)
 {
-    os.write((char*)src, stride);
-    srcOffset += stride;
+    if (batchSize == 0) throw std::invalid_argument("`batch_size` must be at least one record");
+    if (!callback) throw std::invalid_argument("`callback` is empty");
+
+    // Errors for unknown or already requested keys are reported as for any other request
+    request_properties_from_element(elementKey, propertyKeys, list_size_hint, type);
+
+    BatchRequest batch;
+    batch.element = size_t(find_element(elementKey));
+    batch.callback = callback;
+    for (auto key : propertyKeys)
+    {
+        ParsingHelper& helper = userData[property_key(batch.element, size_t(find_property(batch.element, key)))];
+        helper.batchSize = batchSize;
+        batch.helper = &helper;
+    }
+    batchRequests.push_back(batch);
 }
 
-void PlyFile::PlyFileImpl::read(std::istream& is)
+PlyTriangulatedFaces PlyFile::PlyFileImpl::request_triangulated_faces(const std::string& elementKey,
+    const std::string& propertyKey, const bool polygonOffsets)
 {
-    std::vector<std::shared_ptr<PlyData>> buffers;
-    for (auto& entry : userData) buffers.push_back(entry.second.data);
+    const int64_t elementIndex = find_element(elementKey);
+    if (elementIndex >= 0)
+    {
+        const PlyElement& element = elements[elementIndex];
+        const int64_t propertyIndex = find_property(size_t(elementIndex), propertyKey);
+        if (propertyIndex >= 0)
+        {
+            const PlyProperty& property = element.properties[propertyIndex];
+            if (!property.isList || property.propertyType == Type::FLOAT32 || property.propertyType == Type::FLOAT64)
+                throw std::invalid_argument("triangulated faces require a list of integer indices: " + elementKey + " " + propertyKey);
+        }
+    }
 
-    // Discover if we can allocate up front without parsing the file twice 
-    uint32_t list_hints = 0;
-    for (auto& b : buffers) for (auto& entry : userData) { list_hints += entry.second.list_size_hint; (void)b; }
+    // Errors for unknown or already requested keys are reported as for any other request
+    PlyTriangulatedFaces faces;
+    faces.triangles = request_properties_from_element(elementKey, { propertyKey }, 0);
 
-    // No list hints? Then we need to calculate how much memory to allocate
-    if (list_hints == 0) parse_data(is, true);
+    // Until `read` completes, `count` is the number of polygons
+    ParsingHelper& helper = userData[property_key(size_t(elementIndex), size_t(find_property(size_t(elementIndex), propertyKey)))];
+    helper.triangulate = true;
+    helper.data->t = Type::UINT32;
+    helper.data->isList = false;
 
-    // Count the number of properties (required for allocation)
-    // e.g. if we have properties x y and z requested, we ensure
-    // that their buffer points to the same PlyData 
-    std::unordered_map<PlyData*, int32_t> unique_data_count;
-    for (auto& ptr : buffers) unique_data_count[ptr.get()] += 1;
+    if (polygonOffsets)
+    {
+        faces.polygon_offsets = std::make_shared<PlyData>();
+        faces.polygon_offsets->t = Type::UINT32;
+        faces.polygon_offsets->count = helper.data->count + 1; // allocated by `read`
+        helper.polygonOffsets = faces.polygon_offsets;
+        requestedData.push_back(faces.polygon_offsets);
+    }
+    return faces;
+}
 
-    // Since group-requested properties share the same cursor, 
-    // we need to find unique cursors so we only allocate once
-    std::sort(buffers.begin(), buffers.end());
-    buffers.erase(std::unique(buffers.begin(), buffers.end()), buffers.end());
+PlyGaussianSplats PlyFile::PlyFileImpl::request_gaussian_splats(const std::string& elementKey, const bool activate)
+{
+    const int64_t elementIndex = find_element(elementKey);
+    if (elementIndex < 0) throw std::invalid_argument("the element key was not found in the header: " + elementKey);
+    const size_t e = size_t(elementIndex);
+
+    // The degree of the spherical harmonics follows from the number of f_rest_* properties
+    static const size_t restCounts[] = { 0, 9, 24, 45 };
+    size_t numRest = 0;
+    while (find_property(e, "f_rest_" + std::to_string(numRest)) >= 0) ++numRest;
+    const size_t degree = size_t(std::find(restCounts, restCounts + 4, numRest) - restCounts);
+    if (degree == 4) throw std::invalid_argument("not a gaussian splat element, unexpected number of f_rest_* properties: " + std::to_string(numRest));
+
+    // Properties in the order of the output arrays
+    std::vector<std::string> keys = { "x", "y", "z", "scale_0", "scale_1", "scale_2", "rot_0", "rot_1", "rot_2", "rot_3", "opacity", "f_dc_0", "f_dc_1", "f_dc_2" };
+    for (size_t i = 0; i < numRest; ++i) keys.push_back("f_rest_" + std::to_string(i));
+
+    std::vector<size_t> propertyIndices;
+    std::stringstream missing;
+    for (auto& key : keys)
+    {
+        const int64_t propertyIndex = find_property(e, key);
+        if (propertyIndex < 0) missing << key << ", ";
+        else if (elements[e].properties[propertyIndex].isList) throw std::invalid_argument("not a gaussian splat element, list property: " + key);
+        else propertyIndices.push_back(size_t(propertyIndex));
+    }
+    if (!missing.str().empty()) throw std::invalid_argument("not a gaussian splat element, missing properties: " + missing.str());
+
+    // A batch holds the requested properties packed in file order: the column of each key is its
+    // rank among the requested property indices
+    std::vector<size_t> sorted = propertyIndices;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<uint32_t> columns;
+    for (const size_t propertyIndex : propertyIndices)
+        columns.push_back(uint32_t(std::lower_bound(sorted.begin(), sorted.end(), propertyIndex) - sorted.begin()));
+
+    PlyGaussianSplats splats;
+    splats.count = elements[e].size;
+    splats.sh_degree = degree;
+    const size_t numKeys = keys.size();
+    const size_t widths[5] = { 3, 3, 4, 1, numKeys - 11 };
+    std::shared_ptr<PlyData>* arrays[5] = { &splats.positions, &splats.scales, &splats.rotations, &splats.opacities, &splats.sh };
+    for (size_t a = 0; a < 5; ++a)
+    {
+        *arrays[a] = std::make_shared<PlyData>();
+        (*arrays[a])->t = Type::FLOAT32;
+        (*arrays[a])->count = splats.count;
+        splatArrays.emplace_back(*arrays[a], widths[a]); // allocated by `read`, before any batch
+    }
 
-    // We sorted by ptrs on PlyData, need to remap back onto its cursor in the userData table
-    for (auto& b : buffers)
+    // Batches of 1024 records (up to 248 KB) stay in cache between being decoded and scattered
+    const PlyGaussianSplats out = splats;
+    request_batches(elementKey, keys, 1024, [out, columns, numKeys, activate](const PlyData& batch, size_t first)
     {
-        for (auto& entry : userData)
+        float* arrays[5];
+        const size_t widths[5] = { 3, 3, 4, 1, numKeys - 11 };
+        const std::shared_ptr<PlyData> data[5] = { out.positions, out.scales, out.rotations, out.opacities, out.sh };
+        for (size_t a = 0; a < 5; ++a) arrays[a] = reinterpret_cast<float*>(data[a]->buffer.get()) + first * widths[a];
+
+        const float* record = reinterpret_cast<const float*>(batch.buffer.get());
+        const uint32_t* c = columns.data();
+        for (size_t i = 0; i < batch.count; ++i, record += numKeys)
         {
-            if (entry.second.data == b && b->buffer.get() == nullptr)
+            float* position = arrays[0] + i * 3;
+            float* scale = arrays[1] + i * 3;
+            float* rotation = arrays[2] + i * 4;
+            float* sh = arrays[4] + i * widths[4];
+            for (size_t k = 0; k < 3; ++k) position[k] = record[c[k]];
+            for (size_t k = 0; k < 3; ++k) scale[k] = record[c[3 + k]];
+            for (size_t k = 0; k < 4; ++k) rotation[k] = record[c[6 + k]];
+            arrays[3][i] = record[c[10]];
+            for (size_t k = 0; k < widths[4]; ++k) sh[k] = record[c[11 + k]];
+
+            if (activate)
             {
-                // If we didn't receive any list hints, it means we did two passes over the
-                // file to compute the total length of all (potentially) variable-length lists
-                if (list_hints == 0)
-                {
-                    b->buffer = Buffer(entry.second.cursor->totalSizeBytes);
-                }
-                else
-                {
-                    // otherwise, we can allocate up front, skipping the first pass.
-                    const size_t list_size_multiplier = (entry.second.data->isList ? entry.second.list_size_hint : 1);
-                    auto bytes_per_property = entry.second.data->count * PropertyTable[entry.second.data->t].stride * list_size_multiplier;
-                    bytes_per_property *= unique_data_count[b.get()];
-                    b->buffer = Buffer(bytes_per_property);
-                }
-
+                for (size_t k = 0; k < 3; ++k) scale[k] = std::exp(scale[k]);
+                arrays[3][i] = 1.0f / (1.0f + std::exp(-arrays[3][i]));
+                const float norm = std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+                if (norm > 0.0f) for (size_t k = 0; k < 4; ++k) rotation[k] /= norm;
             }
         }
-    }
+    }, 0, Type::FLOAT32);
+    return splats;
+}
 
-    // Populate the data
-    parse_data(is, false);
+void PlyFile::PlyFileImpl::add_properties_to_element(const std::string& elementKey,
+    const std::initializer_list<std::string> propertyKeys,
+    const Type type, const size_t count, uint8_t* data, const Type listType, const size_t listCount)
+{
+    ParsingHelper helper;
+    helper.data = std::make_shared<PlyData>();
+    helper.data->count = count;
+    helper.data->t = type;
+    helper.data->buffer = Buffer(data);
+    helper.cursor = std::make_shared<PlyDataCursor>();
 
-    if (isBigEndian)
+    auto create_property_on_element = [&](PlyElement& e, const size_t elementIndex)
     {
-        for (auto& b : buffers)
+        for (auto key : propertyKeys)
         {
-            uint8_t* data_ptr = b->buffer.get();
-            const size_t stride = PropertyTable[b->t].stride;
-            const size_t buffer_size_bytes = b->buffer.size_bytes();
-
-            switch (b->t)
-            {
-            case Type::INT16:   endian_swap_buffer<int16_t, int16_t>(data_ptr, buffer_size_bytes, stride);   break;
-            case Type::UINT16:  endian_swap_buffer<uint16_t, uint16_t>(data_ptr, buffer_size_bytes, stride); break;
-            case Type::INT32:   endian_swap_buffer<int32_t, int32_t>(data_ptr, buffer_size_bytes, stride);   break;
-            case Type::UINT32:  endian_swap_buffer<uint32_t, uint32_t>(data_ptr, buffer_size_bytes, stride); break;
-            case Type::FLOAT32: endian_swap_buffer<uint32_t, float>(data_ptr, buffer_size_bytes, stride);    break;
-            case Type::FLOAT64: endian_swap_buffer<uint64_t, double>(data_ptr, buffer_size_bytes, stride);   break;
-            default: break;
-            }
+            PlyProperty newProp = (listType == Type::INVALID) ? PlyProperty(type, key) : PlyProperty(listType, type, key, listCount);
+            userData.insert(std::pair<uint64_t, ParsingHelper>(property_key(elementIndex, e.properties.size()), helper));
+            e.properties.push_back(newProp);
         }
+    };
+
+    const int64_t idx = find_element(elementKey);
+    if (idx >= 0)
+    {
+        PlyElement& e = elements[idx];
+        create_property_on_element(e, size_t(idx));
+    }
+    else
+    {
+        PlyElement newElement = (listType == Type::INVALID) ? PlyElement(elementKey, count) : PlyElement(elementKey, count);
+        create_property_on_element(newElement, elements.size());
+        elements.push_back(newElement);
     }
+    index_names();
 }
 
-void PlyFile::PlyFileImpl::write(std::ostream& os, bool _isBinary)
+void PlyFile::PlyFileImpl::parse_data(std::istream& is)
 {
-    // reset cursors
-    for (auto& d : userData) { d.second.cursor->byteOffset = 0; }
-    if (_isBinary) write_binary_internal(os);
-    else write_ascii_internal(os);
-}
+    if (!isBinary && options.fast_ascii) return parse_data_ascii(is);
 
-void PlyFile::PlyFileImpl::write_binary_internal(std::ostream& os)
-{
-    isBinary = true;
-    write_header(os);
+    auto element_property_lookup = make_property_lookup_table();
 
-    uint8_t listSize[4] = { 0, 0, 0, 0 };
-    size_t dummyCount = 0;
+    if (isBinary)
+    {
+        // Elements after the last one with anything to decode are not read at all
+        auto requested = [](const std::vector<PropertyLookup>& lookups) { return std::any_of(lookups.begin(), lookups.end(), [](const PropertyLookup& f) { return !f.skip; }); };
+        size_t numElements = elements.size();
+        while (numElements > 0 && !requested(element_property_lookup[numElements - 1])) --numElements;
+
+        memory_streambuf* memory = dynamic_cast<memory_streambuf*>(is.rdbuf());
+        stats_clock::time_point since = stats_clock::now();
+        for (size_t element_idx = 0; element_idx < numElements; ++element_idx)
+        {
+            const PlyElement& element = elements[element_idx];
+            auto& lookups = element_property_lookup[element_idx];
+            const bool fixedSize = std::none_of(element.properties.begin(), element.properties.end(), [](const PlyProperty& p) { return p.isList; });
 
-    auto element_property_lookup = make_property_lookup_table();
+            // A list-free element with nothing requested is stepped over in one go
+            if (fixedSize && !requested(lookups))
+            {
+                size_t recordStride = 0;
+                for (auto& f : lookups) recordStride += f.prop_stride;
+                skip_binary(is, memory, recordStride * element.size, element);
+            }
+            else if (fixedSize && options.bulk_binary) parse_fixed_element_binary(element, lookups, is, batches_of(element_idx), &stats);
+            else parse_element_binary(element, lookups, is);
+            element_decoded(element_idx, since);
+        }
+        return;
+    }
 
-    size_t element_idx = 0;
-    for (auto& e : elements)
+    size_t listSize = 0;
+    size_t dummyCount = 0;
+    std::string skip_ascii_buffer;
+
+    auto read = [this, &listSize, &dummyCount](PropertyLookup& f, const PlyProperty& p, std::istream& _is)
     {
-        for (size_t i = 0; i < e.size; ++i)
+        size_t& destOffset = f.helper->cursor->byteOffset;
+        if (!p.isList)
         {
-            size_t property_index = 0;
-            for (auto& p : e.properties)
+            uint8_t* dst = f.convert ? scratch : reserve_bytes(*f.helper, f.prop_stride);
+            read_property_ascii(p.propertyType, f.prop_stride, dst, dummyCount, _is);
+            if (f.convert) f.convert(reserve_bytes(*f.helper, f.dst_stride), dst, 1);
+            destOffset += f.dst_stride;
+        }
+        else if (f.helper->triangulate)
+        {
+            read_property_ascii(p.listType, f.list_stride, &listSize, dummyCount, _is); // the number of indices
+            staging.resize(f.prop_stride * listSize);
+            for (size_t i = 0; i < listSize; ++i)
             {
-                auto& f = element_property_lookup[element_idx][property_index];
-                auto* helper = f.helper;
+                read_property_ascii(p.propertyType, f.prop_stride, staging.data() + i * f.prop_stride, dummyCount, _is);
+            }
+            append_polygon(*f.helper, p.propertyType, f.prop_stride, staging.data(), listSize);
+        }
+        else
+        {
+            read_property_ascii(p.listType, f.list_stride, &listSize, dummyCount, _is); // the list size
+            if (f.convert) staging.resize(f.prop_stride * listSize);
+            uint8_t* dst = f.convert ? staging.data() : reserve_bytes(*f.helper, f.prop_stride * listSize);
+            for (size_t i = 0; i < listSize; ++i)
+            {
+                read_property_ascii(p.propertyType, f.prop_stride, dst + i * f.prop_stride, dummyCount, _is);
+            }
+            if (f.convert) f.convert(reserve_bytes(*f.helper, f.dst_stride * listSize), dst, listSize);
+            destOffset += f.dst_stride * listSize;
+        }
+    };
 
-                if (p.isList)
-                {
-                    std::memcpy(listSize, &p.listCount, sizeof(uint32_t));
-                    write_property_binary(p.listType, os, listSize, dummyCount, f.list_stride);
-                    write_property_binary(p.propertyType, os, (helper->data->buffer.get() + helper->cursor->byteOffset), helper->cursor->byteOffset, f.prop_stride * p.listCount);
-                }
-                else
-                {
-                    write_property_binary(p.propertyType, os, (helper->data->buffer.get() + helper->cursor->byteOffset), helper->cursor->byteOffset, f.prop_stride);
-                }
-                property_index++;
+    auto skip = [this, &listSize, &dummyCount, &skip_ascii_buffer](PropertyLookup& f, const PlyProperty& p, std::istream& _is)
+    {
+        skip_ascii_buffer.clear();
+        if (p.isList)
+        {
+            read_property_ascii(p.listType, f.list_stride, &listSize, dummyCount, _is); // the list size
+            for (size_t i = 0; i < listSize; ++i) _is >> skip_ascii_buffer; // properties in list
+            return;
+        }
+        _is >> skip_ascii_buffer;
+    };
+
+    stats_clock::time_point since = stats_clock::now();
+    for (size_t element_idx = 0; element_idx < elements.size(); ++element_idx)
+    {
+        const PlyElement& element = elements[element_idx];
+        auto& lookups = element_property_lookup[element_idx];
+        const std::vector<BatchRequest*> batches = batches_of(element_idx);
+        for (size_t count = 0; count < element.size; ++count)
+        {
+            for (size_t i = 0; i < element.properties.size(); ++i)
+            {
+                if (!lookups[i].skip) read(lookups[i], element.properties[i], is);
+                else skip(lookups[i], element.properties[i], is);
             }
+            if (!batches.empty()) end_records(batches, 1);
         }
-        element_idx++;
+        element_decoded(element_idx, since);
     }
 }
 
-void PlyFile::PlyFileImpl::write_ascii_internal(std::ostream& os)
+void PlyFile::PlyFileImpl::skip_binary(std::istream& is, memory_streambuf* memory, const size_t bytes, const PlyElement& element)
 {
-    write_header(os);
+    stats.bytes_skipped += bytes;
+    if (memory)
+    {
+        if (memory->remaining() < bytes) throw std::runtime_error("unexpected end of file in element " + element.name);
+        memory->advance(bytes);
+        return;
+    }
 
-    for (auto& e : elements)
+    // A seek drops whatever the stream has buffered, so only long skips seek. Shorter ones, and
+    // streams that cannot seek (pipes), are consumed from the stream buffer with `ignore`.
+    if (bytes >= options.block_size_bytes && is.tellg() != std::streampos(-1))
     {
-        for (size_t i = 0; i < e.size; ++i)
+        if (is.seekg(std::streamoff(bytes), std::ios::cur)) return;
+        is.clear();
+    }
+
+    if (size_t(is.ignore(std::streamsize(bytes)).gcount()) != bytes) throw std::runtime_error("unexpected end of file in element " + element.name);
+}
+
+std::vector<PlyFile::PlyFileImpl::DecodeOp> PlyFile::PlyFileImpl::compile_element_binary(const PlyElement& element, const std::vector<PropertyLookup>& lookups)
+{
+    std::vector<DecodeOp> program;
+
+    for (size_t i = 0; i < element.properties.size(); ++i)
+    {
+        const PlyProperty& p = element.properties[i];
+        const PropertyLookup& f = lookups[i];
+
+        DecodeOp op{};
+        op.helper = f.skip ? nullptr : f.helper;
+        op.width = f.prop_stride;
+        op.dstWidth = f.dst_stride;
+        op.convert = f.convert;
+        op.valueType = p.propertyType;
+
+        if (p.isList)
         {
-            for (auto& p : e.properties)
+            op.countType = p.listType;
+            op.countWidth = f.list_stride;
+            if (f.skip) op.kind = DecodeOp::SkipList;
+            else if (f.helper->triangulate) op.kind = DecodeOp::TriangulateList;
+            else op.kind = f.convert ? DecodeOp::ConvertList : DecodeOp::CopyList;
+            program.push_back(op);
+            continue;
+        }
+
+        op.kind = f.skip ? DecodeOp::Skip : (f.convert ? DecodeOp::Convert : DecodeOp::Copy);
+        op.bytes = f.prop_stride;
+
+        // Properties of a group are packed in file order, so neighbours in the file are neighbours
+        // in the destination too. Big endian copies are swapped per op, so they need one width.
+        if (!program.empty())
+        {
+            DecodeOp& last = program.back();
+            const bool sameGroup = last.helper && op.helper && last.helper->data == op.helper->data;
+            bool merge = false;
+            if (op.kind == DecodeOp::Skip) merge = last.kind == DecodeOp::Skip;
+            else if (op.kind == DecodeOp::Copy) merge = last.kind == DecodeOp::Copy && sameGroup && (!isBigEndian || last.width == op.width);
+            else merge = last.kind == DecodeOp::Convert && sameGroup && last.convert == op.convert && last.width == op.width;
+            if (merge)
             {
-                auto& helper = userData[hash_fnv1a(e.name + p.name)];
-                if (p.isList)
-                {
-                    os << p.listCount << " ";
-                    for (size_t j = 0; j < p.listCount; ++j)
-                    {
-                        write_property_ascii(p.propertyType, os, (helper.data->buffer.get() + helper.cursor->byteOffset), helper.cursor->byteOffset);
-                    }
-                }
-                else
-                {
-                    write_property_ascii(p.propertyType, os, (helper.data->buffer.get() + helper.cursor->byteOffset), helper.cursor->byteOffset);
-                }
+                last.bytes += op.bytes;
+                continue;
             }
-            os << "\n";
         }
+        program.push_back(op);
     }
+
+    return program;
 }
 
-void PlyFile::PlyFileImpl::write_header(std::ostream& os)
+void PlyFile::PlyFileImpl::parse_element_binary(const PlyElement& element, const std::vector<PropertyLookup>& lookups, std::istream& is)
 {
-    const std::locale& fixLoc = std::locale("C");
-    os.imbue(fixLoc);
+    const std::vector<DecodeOp> program = compile_element_binary(element, lookups);
+    const std::vector<BatchRequest*> batches = batches_of(size_t(&element - elements.data()));
+    memory_streambuf* memory = dynamic_cast<memory_streambuf*>(is.rdbuf());
 
-    os << "ply\n";
-    if (isBinary) os << ((isBigEndian) ? "format binary_big_endian 1.0" : "format binary_little_endian 1.0") << "\n";
-    else os << "format ascii 1.0\n";
+    // Counted locally: stream reads may alias the members
+    size_t bytesRead = 0, readCalls = 0;
+    auto read_bytes = [&](uint8_t* dst, const size_t bytes)
+    {
+        if (!is.read((char*)dst, bytes)) throw std::runtime_error("unexpected end of file in element " + element.name);
+        bytesRead += bytes;
+        ++readCalls;
+    };
 
-    for (const auto& comment : comments) os << "comment " << comment << "\n";
+    // The count is needed as the file is read, so it is flipped and widened right away
+    auto read_count = [&](const DecodeOp& op)
+    {
+        uint8_t raw[8];
+        read_bytes(raw, op.countWidth);
+        if (isBigEndian) endian_swap_one(raw, op.countWidth);
+        return list_count_from_bytes(op.countType, raw);
+    };
 
-    for (auto& e : elements)
+    // Values are flipped in place right after they are read, rather than in a second pass over the buffers
+    for (size_t count = 0; count < element.size; ++count)
     {
-        os << "element " << e.name << " " << e.size << "\n";
-        for (const auto& p : e.properties)
+        for (const DecodeOp& op : program)
         {
-            if (p.isList)
+            switch (op.kind)
+            {
+            case DecodeOp::Copy:
+            {
+                uint8_t* dst = reserve_bytes(*op.helper, op.bytes);
+                read_bytes(dst, op.bytes);
+                if (isBigEndian) endian_swap_inplace(dst, op.bytes / op.width, op.width);
+                op.helper->cursor->byteOffset += op.bytes;
+                break;
+            }
+            case DecodeOp::Convert:
+            {
+                const size_t numValues = op.bytes / op.width;
+                staging.resize(op.bytes);
+                read_bytes(staging.data(), op.bytes);
+                if (isBigEndian) endian_swap_inplace(staging.data(), numValues, op.width);
+                op.convert(reserve_bytes(*op.helper, numValues * op.dstWidth), staging.data(), numValues);
+                op.helper->cursor->byteOffset += numValues * op.dstWidth;
+                break;
+            }
+            case DecodeOp::Skip:
+            {
+                skip_binary(is, memory, op.bytes, element);
+                break;
+            }
+            case DecodeOp::CopyList:
+            {
+                const size_t listSize = read_count(op);
+                uint8_t* dst = reserve_bytes(*op.helper, listSize * op.width);
+                read_bytes(dst, listSize * op.width);
+                if (isBigEndian) endian_swap_inplace(dst, listSize, op.width);
+                op.helper->cursor->byteOffset += listSize * op.width;
+                break;
+            }
+            case DecodeOp::ConvertList:
+            {
+                const size_t listSize = read_count(op);
+                staging.resize(listSize * op.width);
+                read_bytes(staging.data(), staging.size());
+                if (isBigEndian) endian_swap_inplace(staging.data(), listSize, op.width);
+                op.convert(reserve_bytes(*op.helper, listSize * op.dstWidth), staging.data(), listSize);
+                op.helper->cursor->byteOffset += listSize * op.dstWidth;
+                break;
+            }
+            case DecodeOp::TriangulateList:
             {
-                os << "property list " << PropertyTable[p.listType].str << " "
-                    << PropertyTable[p.propertyType].str << " " << p.name << "\n";
+                const size_t listSize = read_count(op); // the number of indices
+                staging.resize(listSize * op.width);
+                read_bytes(staging.data(), staging.size());
+                if (isBigEndian) endian_swap_inplace(staging.data(), listSize, op.width);
+                append_polygon(*op.helper, op.valueType, op.width, staging.data(), listSize);
+                break;
             }
-            else
+            case DecodeOp::SkipList:
             {
-                os << "property " << PropertyTable[p.propertyType].str << " " << p.name << "\n";
+                skip_binary(is, memory, read_count(op) * op.width, element);
+                break;
+            }
             }
         }
+        if (!batches.empty()) end_records(batches, 1);
     }
-    os << "end_header\n";
+    stats.bytes_read += bytesRead;
+    stats.read_calls += readCalls;
 }
 
-std::shared_ptr<PlyData> PlyFile::PlyFileImpl::request_properties_from_element(const std::string& elementKey,
-    const std::initializer_list<std::string> propertyKeys,
-    const uint32_t list_size_hint)
+void PlyFile::PlyFileImpl::parse_fixed_element_binary(const PlyElement& element, std::vector<PropertyLookup>& lookups, std::istream& is,
+    const std::vector<BatchRequest*>& batches, PlyReadStats* counted)
 {
-    // Each key in `propertyKey` gets an entry into the userData map (keyed by a hash of
-    // element name and property name), but groups of properties (requested from the
-    // public api through this function) all share the same `ParsingHelper`. When it comes 
-    // time to .read(), we check the number of unique PlyData shared pointers
-    // and allocate a single buffer that will be used by each individual property. 
-    ParsingHelper helper;
-    helper.data = std::make_shared<PlyData>();
-    helper.data->count = 0;
-    helper.data->isList = false;
-    helper.data->t = Type::INVALID;
-    helper.cursor = std::make_shared<PlyDataCursor>();
-    helper.list_size_hint = list_size_hint;
-
-    if (elements.empty()) throw std::runtime_error("header had no elements defined. malformed file?");
-    if (elementKey.empty()) throw std::invalid_argument("`elementKey` argument is empty");
-    if (!propertyKeys.size()) throw std::invalid_argument("`propertyKeys` argument is empty");
-
-    const int64_t elementIndex = find_element(elementKey, elements);
-
-    std::vector<std::string> keys_not_found;
+    // A run of adjacent properties in the file record that land next to each other in the
+    // same destination group. Copying a run is a single memcpy per record. Runs that are converted
+    // to another type hold properties of one source type, and are first packed, then converted.
+    struct CopySpan
+    {
+        ParsingHelper* helper;
+        size_t srcOffset;
+        size_t dstOffset; // within one destination record of the group
+        size_t bytes;
+        deinterleave_fn kernel;
+        convert_fn convert;
+        size_t srcWidth;
+        size_t dstBytes;
+    };
 
-    // Sanity check if the user requested element is in the pre-parsed header
-    if (elementIndex >= 0)
+    // One entry per distinct requested group, with the number of bytes it receives per record
+    // and the (offset, width) of each of its unconverted properties for byte swapping
+    struct GroupStride
     {
-        // We found the element
-        const PlyElement& element = elements[elementIndex];
+        ParsingHelper* helper;
+        size_t bytes;
+        std::vector<std::pair<size_t, size_t>> fields;
+        bool converted;
+    };
 
-        helper.data->count = element.size;
+    std::vector<CopySpan> spans;
+    std::vector<GroupStride> groups;
+    size_t recordStride = 0;
 
-        // Find each of the keys
-        for (auto key : propertyKeys)
+    for (size_t i = 0; i < element.properties.size(); ++i)
+    {
+        const PropertyLookup& f = lookups[i];
+        if (!f.skip)
         {
-            const int64_t propertyIndex = find_property(key, element.properties);
-            // The key was not found
-            if (propertyIndex < 0)
+            auto group = std::find_if(groups.begin(), groups.end(), [&](const GroupStride& g) { return g.helper->data == f.helper->data; });
+            if (group == groups.end()) group = groups.insert(groups.end(), GroupStride{ f.helper, 0, {}, false });
+
+            // Struct requests place each field at its offset in T; other groups are packed
+            const size_t dstOffset = f.helper->structStride ? f.helper->structOffset : group->bytes;
+            if (f.convert) group->converted = true;
+            else group->fields.emplace_back(dstOffset, f.prop_stride);
+
+            if (!spans.empty() && spans.back().helper->data == f.helper->data &&
+                spans.back().srcOffset + spans.back().bytes == recordStride &&
+                spans.back().dstOffset + spans.back().dstBytes == dstOffset &&
+                spans.back().convert == f.convert && spans.back().srcWidth == (f.convert ? f.prop_stride : 0))
             {
-                keys_not_found.push_back(key);
+                spans.back().bytes += f.prop_stride;
+                spans.back().dstBytes += f.dst_stride;
             }
+            else spans.push_back(CopySpan{ f.helper, recordStride, dstOffset, f.prop_stride, nullptr, f.convert, f.convert ? f.prop_stride : 0, f.dst_stride });
+
+            group->bytes = f.helper->structStride ? f.helper->structStride : group->bytes + f.dst_stride;
         }
+        recordStride += f.prop_stride;
+    }
 
-        if (keys_not_found.size())
+    for (auto& span : spans)
+    {
+        const size_t dstStride = std::find_if(groups.begin(), groups.end(), [&](const GroupStride& g) { return g.helper->data == span.helper->data; })->bytes;
+        span.kernel = select_deinterleave_kernel(span.bytes, recordStride, span.convert ? span.bytes : dstStride);
+    }
+
+    if (recordStride == 0 || element.size == 0) return;
+
+    // Mapped input can be consumed in place; everything else is read block by block
+    memory_streambuf* memory = dynamic_cast<memory_streambuf*>(is.rdbuf());
+
+    const size_t recordsPerBlock = std::max<size_t>(1, options.block_size_bytes / recordStride);
+    std::vector<uint8_t> block;
+    if (!memory) block.resize(std::min(recordsPerBlock, element.size) * recordStride);
+    std::vector<uint8_t> packed, converted; // per block, for converted spans
+
+    // Counted locally and added to |counted| (when set) at the end: ranges are read concurrently
+    size_t bytesRead = 0, readCalls = 0;
+    size_t remaining = element.size;
+    while (remaining > 0)
+    {
+        const size_t numRecords = records_until_batch(batches, std::min(recordsPerBlock, remaining));
+        const size_t numBytes = numRecords * recordStride;
+        const uint8_t* src = nullptr;
+
+        if (memory)
         {
-            std::stringstream ss;
-            for (auto& str : keys_not_found) ss << str << ", ";
-            throw std::invalid_argument("the following property keys were not found in the header: " + ss.str());
+            if (memory->remaining() < numBytes) throw std::runtime_error("unexpected end of file in element " + element.name);
+            src = memory->cursor();
+            memory->advance(numBytes);
+        }
+        else
+        {
+            if (!is.read((char*)block.data(), numBytes)) throw std::runtime_error("unexpected end of file in element " + element.name);
+            src = block.data();
+            ++readCalls;
         }
+        bytesRead += numBytes;
 
-        for (auto key : propertyKeys)
+        for (const auto& g : groups)
         {
-            const int64_t propertyIndex = find_property(key, element.properties);
-            const PlyProperty& property = element.properties[propertyIndex];
-            helper.data->t = property.propertyType;
-            helper.data->isList = property.isList;
-            auto result = userData.insert(std::pair<uint32_t, ParsingHelper>(hash_fnv1a(element.name + property.name), helper));
-            if (result.second == false)
+            const size_t dstStride = g.bytes;
+            for (const auto& span : spans)
             {
-                throw std::invalid_argument("element-property key has already been requested: " + element.name + " " + property.name);
+                if (span.helper->data != g.helper->data) continue;
+                uint8_t* dst = g.helper->data->buffer.get() + g.helper->cursor->byteOffset + span.dstOffset;
+                if (!span.convert)
+                {
+                    if (span.kernel) span.kernel(dst, dstStride, src + span.srcOffset, recordStride, numRecords);
+                    else deinterleave_any(dst, dstStride, src + span.srcOffset, recordStride, numRecords, span.bytes);
+                    continue;
+                }
+
+                // Pack the run (already packed when it is the whole record), swap, then convert
+                // straight into the destination, or into a packed block that is scattered
+                const uint8_t* values = src + span.srcOffset;
+                if (span.bytes != recordStride || isBigEndian)
+                {
+                    packed.resize(numRecords * span.bytes);
+                    if (span.kernel) span.kernel(packed.data(), span.bytes, src + span.srcOffset, recordStride, numRecords);
+                    else deinterleave_any(packed.data(), span.bytes, src + span.srcOffset, recordStride, numRecords, span.bytes);
+                    if (isBigEndian) endian_swap_inplace(packed.data(), numRecords * span.bytes / span.srcWidth, span.srcWidth);
+                    values = packed.data();
+                }
+
+                const size_t numValues = numRecords * span.bytes / span.srcWidth;
+                if (span.dstBytes == dstStride) span.convert(dst, values, numValues);
+                else
+                {
+                    converted.resize(numRecords * span.dstBytes);
+                    span.convert(converted.data(), values, numValues);
+                    deinterleave_any(dst, dstStride, converted.data(), span.dstBytes, numRecords, span.dstBytes);
+                }
+            }
+
+            // Swap the block just written while it is still in cache
+            if (isBigEndian && !g.fields.empty())
+            {
+                uint8_t* dst = g.helper->data->buffer.get() + g.helper->cursor->byteOffset;
+                const size_t width = g.fields.front().second;
+                const bool uniform = !g.converted && width * g.fields.size() == dstStride && std::all_of(g.fields.begin(), g.fields.end(), [&](const std::pair<size_t, size_t>& field) { return field.second == width; });
+                if (uniform) endian_swap_inplace(dst, numRecords * g.fields.size(), width);
+                else for (const auto& field : g.fields) endian_swap_strided(dst + field.first, numRecords, field.second, dstStride);
             }
+
+            g.helper->cursor->byteOffset += numRecords * dstStride;
         }
-    }
-    else throw std::invalid_argument("the element key was not found in the header: " + elementKey);
 
-    if (keys_not_found.size())
+        end_records(batches, numRecords);
+        remaining -= numRecords;
+    }
+    if (counted)
     {
-        std::stringstream ss;
-        for (auto& str : keys_not_found) ss << str << ", ";
-        throw std::invalid_argument("the following property keys were not found in the header: " + ss.str());
+        counted->bytes_read += bytesRead;
+        counted->read_calls += readCalls;
     }
-    return helper.data;
 }
 
-void PlyFile::PlyFileImpl::add_properties_to_element(const std::string& elementKey,
-    const std::initializer_list<std::string> propertyKeys,
-    const Type type, const size_t count, uint8_t* data, const Type listType, const size_t listCount)
+void PlyFile::PlyFileImpl::parse_data_ascii(std::istream& is)
 {
-    ParsingHelper helper;
-    helper.data = std::make_shared<PlyData>();
-    helper.data->count = count;
-    helper.data->t = type;
-    helper.data->buffer = Buffer(data);
-    helper.cursor = std::make_shared<PlyDataCursor>();
-
-    auto create_property_on_element = [&](PlyElement& e)
+    if (options.num_threads != 1 && batchRequests.empty())
     {
-        for (auto key : propertyKeys)
+        if (memory_streambuf* memory = dynamic_cast<memory_streambuf*>(is.rdbuf()))
         {
-            PlyProperty newProp = (listType == Type::INVALID) ? PlyProperty(type, key) : PlyProperty(listType, type, key, listCount);
-            userData.insert(std::pair<uint32_t, ParsingHelper>(hash_fnv1a(elementKey + key), helper));
-            e.properties.push_back(newProp);
+            const unsigned int numThreads = options.num_threads ? options.num_threads : std::max(1u, std::thread::hardware_concurrency());
+            const char* begin = reinterpret_cast<const char*>(memory->cursor());
+            if (parse_data_ascii_parallel(begin, begin + memory->remaining(), numThreads))
+            {
+                stats.bytes_read += memory->remaining();
+                return;
+            }
         }
-    };
+    }
 
-    const int64_t idx = find_element(elementKey, elements);
-    if (idx >= 0)
+    AsciiTokenizer tokens(is, options.block_size_bytes);
+    const char* b = nullptr;
+    const char* e = nullptr;
+
+    auto next_token = [&]()
     {
-        PlyElement& e = elements[idx];
-        create_property_on_element(e);
-    }
-    else
+        if (!tokens.next(b, e)) throw std::runtime_error("unexpected end of file");
+    };
+
+    auto element_property_lookup = make_property_lookup_table();
+
+    stats_clock::time_point since = stats_clock::now();
+    for (size_t element_idx = 0; element_idx < elements.size(); ++element_idx)
     {
-        PlyElement newElement = (listType == Type::INVALID) ? PlyElement(elementKey, count) : PlyElement(elementKey, count);
-        create_property_on_element(newElement);
-        elements.push_back(newElement);
+        const PlyElement& element = elements[element_idx];
+        auto& lookups = element_property_lookup[element_idx];
+        const std::vector<BatchRequest*> batches = batches_of(element_idx);
+        for (size_t count = 0; count < element.size; ++count)
+        {
+            for (size_t property_index = 0; property_index < element.properties.size(); ++property_index)
+            {
+                const PlyProperty& property = element.properties[property_index];
+                PropertyLookup& f = lookups[property_index];
+
+                size_t listSize = 1;
+                if (property.isList)
+                {
+                    next_token();
+                    uint8_t raw[8];
+                    ascii_to_property(property.listType, b, e, raw);
+                    listSize = list_count_from_bytes(property.listType, raw);
+                }
+
+                if (f.skip)
+                {
+                    for (size_t i = 0; i < listSize; ++i) next_token();
+                }
+                else if (f.helper->triangulate)
+                {
+                    staging.resize(listSize * f.prop_stride);
+                    for (size_t i = 0; i < listSize; ++i)
+                    {
+                        next_token();
+                        ascii_to_property(property.propertyType, b, e, staging.data() + i * f.prop_stride);
+                    }
+                    append_polygon(*f.helper, property.propertyType, f.prop_stride, staging.data(), listSize);
+                }
+                else
+                {
+                    uint8_t* dest = reserve_bytes(*f.helper, listSize * f.dst_stride);
+                    for (size_t i = 0; i < listSize; ++i, dest += f.dst_stride)
+                    {
+                        next_token();
+                        if (!f.convert) ascii_to_property(property.propertyType, b, e, dest);
+                        else
+                        {
+                            uint8_t raw[8];
+                            ascii_to_property(property.propertyType, b, e, raw);
+                            f.convert(dest, raw, 1);
+                        }
+                    }
+                    f.helper->cursor->byteOffset += listSize * f.dst_stride;
+                }
+            }
+            if (!batches.empty()) end_records(batches, 1);
+        }
+        element_decoded(element_idx, since);
     }
+    stats.bytes_read += tokens.bytes_read();
+    stats.read_calls += tokens.read_calls();
 }
 
-void PlyFile::PlyFileImpl::parse_data(std::istream& is, bool firstPass)
+bool PlyFile::PlyFileImpl::parse_data_ascii_parallel(const char* begin, const char* end, unsigned int numThreads)
 {
-    std::function<void(PropertyLookup & f, const PlyProperty & p, uint8_t * dest, size_t & destOffset, std::istream & is)> read;
-    std::function<size_t(PropertyLookup & f, const PlyProperty & p, std::istream & is)> skip;
+    const NewlineIndex lines(begin, end, numThreads);
 
-    const auto start = is.tellg();
+    size_t totalRecords = 0;
+    for (auto& element : elements) totalRecords += element.size;
+    if (totalRecords > lines.num_lines()) return false; // records span several lines
 
-    size_t listSize = 0;
-    size_t dummyCount = 0;
-    std::string skip_ascii_buffer;
+    auto element_property_lookup = make_property_lookup_table();
 
-    // Special case mirroring read_property_binary but for list types; this
-    // has an additional big endian check to flip the data in place immediately
-    // after reading. We do this as a performance optimization; endian flipping is
-    // done on regular properties as a post-process after reading (also for optimization)
-    // but we need the correct little-endian list count as we read the file. 
-    auto read_list_binary = [this](const Type& t, void* dst, size_t& destOffset, const size_t& stride, std::istream& _is)
+    // On a layout we can't split (e.g. a record wrapped over two lines) the caller falls back to the
+    // serial decoder, which starts over from the same cursors. Arena chunks started since are dropped.
+    struct SavedCursor { ParsingHelper* helper; size_t byteOffset; size_t numPolygons; size_t numSpilled; };
+    std::vector<SavedCursor> savedCursors;
+    for (auto& entry : userData)
     {
-        destOffset += stride;
-        _is.read((char*)dst, stride);
-
-        if (isBigEndian)
+        const PlyDataCursor& cursor = *entry.second.cursor;
+        savedCursors.push_back({ &entry.second, cursor.byteOffset, cursor.numPolygons, cursor.spilled.size() });
+    }
+    auto give_up = [&]()
+    {
+        for (auto& saved : savedCursors)
         {
-            switch (t)
+            PlyDataCursor& cursor = *saved.helper->cursor;
+            while (cursor.spilled.size() > saved.numSpilled)
             {
-            case Type::INT16:  endian_swap<int16_t, int16_t>(*(int16_t*)dst);    break;
-            case Type::UINT16: endian_swap<uint16_t, uint16_t>(*(uint16_t*)dst); break;
-            case Type::INT32:  endian_swap<int32_t, int32_t>(*(int32_t*)dst);    break;
-            case Type::UINT32: endian_swap<uint32_t, uint32_t>(*(uint32_t*)dst); break;
-            default: break;
+                saved.helper->data->buffer = std::move(cursor.spilled.back().first);
+                cursor.spilledBytes -= cursor.spilled.back().second;
+                cursor.spilled.pop_back();
             }
+            cursor.byteOffset = saved.byteOffset;
+            cursor.numPolygons = saved.numPolygons;
         }
-
-        return stride;
+        return false;
     };
 
-    if (isBinary)
+    // Decoding happens in two stages per element. Each chunk of lines is first tokenized to count
+    // the bytes it contributes to every group holding a list; an exclusive prefix sum over the
+    // chunks then gives each chunk its write offset, and the chunks are decoded independently.
+    // Groups without lists need no counting: their offset follows from the record index.
+    std::atomic<bool> malformed(false);
+    std::istream unused(nullptr);
+
+    size_t firstLine = 0;
+    size_t element_idx = 0;
+    stats_clock::time_point since = stats_clock::now();
+    for (auto& element : elements)
     {
-        read = [this, &listSize, &dummyCount, &read_list_binary](PropertyLookup& f, const PlyProperty& p, uint8_t* dest, size_t& destOffset, std::istream& _is)
+        auto& lookups = element_property_lookup[element_idx++];
+        const size_t numProperties = element.properties.size();
+
+        // Distinct requested groups and the group each property writes to (-1 when skipped)
+        std::vector<ParsingHelper*> groups;
+        std::vector<int> groupOf(numProperties, -1);
+        std::vector<size_t> fixedBytes; // per record, for groups without lists
+        std::vector<bool> hasList;
+        for (size_t i = 0; i < numProperties; ++i)
         {
-            if (!p.isList)
-            {
-                read_property_binary(p.propertyType, f.prop_stride, dest + destOffset, destOffset, _is);
-            }
-            else
-            {
-                read_list_binary(p.listType, &listSize, dummyCount, f.list_stride, _is); // the list size
-                read_property_binary(p.propertyType, f.prop_stride * listSize, dest + destOffset, destOffset, _is); // properties in list
-            }
-        };
-        skip = [this, &listSize, &dummyCount, &read_list_binary](PropertyLookup& f, const PlyProperty& p, std::istream& _is)
+            if (lookups[i].skip) continue;
+            auto it = std::find_if(groups.begin(), groups.end(), [&](ParsingHelper* h) { return h->data == lookups[i].helper->data; });
+            groupOf[i] = int(it - groups.begin());
+            if (it == groups.end()) { groups.push_back(lookups[i].helper); fixedBytes.push_back(0); hasList.push_back(false); }
+            fixedBytes[groupOf[i]] += lookups[i].dst_stride;
+            if (element.properties[i].isList) hasList[groupOf[i]] = true;
+        }
+
+        const size_t numChunks = std::max<size_t>(1, std::min<size_t>(numThreads, element.size));
+        std::vector<size_t> chunkFirstRecord(numChunks + 1);
+        std::vector<const char*> chunkBegin(numChunks + 1);
+        for (size_t c = 0; c <= numChunks; ++c)
         {
-            if (!p.isList)
-            {
-                _is.read((char*)scratch, f.prop_stride);
-                return f.prop_stride;
-            }
-            read_list_binary(p.listType, &listSize, dummyCount, f.list_stride, _is); // the list size (does not count for memory alloc)
-            return read_property_binary(p.propertyType, f.prop_stride * listSize, scratch, dummyCount, _is);
-        };
-    }
-    else
-    {
-        read = [this, &listSize, &dummyCount](PropertyLookup& f, const PlyProperty& p, uint8_t* dest, size_t& destOffset, std::istream& _is)
+            chunkFirstRecord[c] = element.size * c / numChunks;
+            chunkBegin[c] = lines.line_start(firstLine + chunkFirstRecord[c]);
+        }
+        firstLine += element.size;
+
+        // Decode (or only measure, when `dest` is empty) one chunk. `offsets` holds the write
+        // position of every group and is advanced as records are decoded.
+        auto run_chunk = [&](size_t c, std::vector<size_t>& offsets, bool measureOnly)
         {
-            if (!p.isList)
-            {
-                read_property_ascii(p.propertyType, f.prop_stride, dest + destOffset, destOffset, _is);
-            }
-            else
+            AsciiTokenizer tokens(unused, chunkBegin[c], chunkBegin[c + 1]);
+            const char* b = nullptr;
+            const char* e = nullptr;
+            auto next_token = [&]() { if (!tokens.next(b, e)) throw std::runtime_error("record crosses a line boundary"); };
+            std::vector<uint8_t> indices;
+
+            for (size_t r = chunkFirstRecord[c]; r < chunkFirstRecord[c + 1]; ++r)
             {
-                read_property_ascii(p.listType, f.list_stride, &listSize, dummyCount, _is); // the list size
-                for (size_t i = 0; i < listSize; ++i)
+                for (size_t i = 0; i < numProperties; ++i)
                 {
-                    read_property_ascii(p.propertyType, f.prop_stride, dest + destOffset, destOffset, _is);
+                    const PlyProperty& property = element.properties[i];
+                    size_t listSize = 1;
+                    if (property.isList)
+                    {
+                        next_token();
+                        uint8_t raw[8];
+                        ascii_to_property(property.listType, b, e, raw);
+                        listSize = list_count_from_bytes(property.listType, raw);
+                    }
+
+                    if (groupOf[i] < 0 || measureOnly)
+                    {
+                        for (size_t k = 0; k < listSize; ++k) next_token();
+                        if (groupOf[i] >= 0) offsets[groupOf[i]] += groups[groupOf[i]]->triangulate ? fan_triangulated_bytes(listSize) : listSize * lookups[i].dst_stride;
+                        continue;
+                    }
+
+                    ParsingHelper& helper = *groups[groupOf[i]];
+                    uint8_t* dest = helper.data->buffer.get();
+                    size_t& destOffset = offsets[groupOf[i]];
+                    if (helper.triangulate)
+                    {
+                        indices.resize(listSize * lookups[i].prop_stride);
+                        for (size_t k = 0; k < listSize; ++k)
+                        {
+                            next_token();
+                            ascii_to_property(property.propertyType, b, e, indices.data() + k * lookups[i].prop_stride);
+                        }
+                        if (helper.polygonOffsets)
+                        {
+                            const uint32_t firstTriangle = static_cast<uint32_t>((helper.cursor->spilledBytes + destOffset) / (3 * sizeof(uint32_t)));
+                            std::memcpy(helper.polygonOffsets->buffer.get() + (helper.cursor->numPolygons + r) * sizeof(uint32_t), &firstTriangle, sizeof(uint32_t));
+                        }
+                        destOffset += fan_triangulate(property.propertyType, lookups[i].prop_stride, indices.data(), listSize, dest + destOffset);
+                        continue;
+                    }
+
+                    for (size_t k = 0; k < listSize; ++k, destOffset += lookups[i].dst_stride)
+                    {
+                        next_token();
+                        if (!lookups[i].convert) ascii_to_property(property.propertyType, b, e, dest + destOffset);
+                        else
+                        {
+                            uint8_t raw[8];
+                            ascii_to_property(property.propertyType, b, e, raw);
+                            lookups[i].convert(dest + destOffset, raw, 1);
+                        }
+                    }
                 }
             }
+            if (tokens.next(b, e)) throw std::runtime_error("record crosses a line boundary");
         };
-        skip = [this, &listSize, &dummyCount, &skip_ascii_buffer](PropertyLookup& f, const PlyProperty& p, std::istream& _is)
+
+        auto run_parallel = [&](std::vector<std::vector<size_t>>& offsets, bool measureOnly)
         {
-            skip_ascii_buffer.clear();
-            if (p.isList)
+            std::vector<std::thread> workers;
+            for (size_t c = 0; c < numChunks; ++c)
             {
-                read_property_ascii(p.listType, f.list_stride, &listSize, dummyCount, _is); // the list size
-                for (size_t i = 0; i < listSize; ++i) _is >> skip_ascii_buffer; // properties in list
-                return listSize * f.prop_stride;
+                workers.emplace_back([&, c]()
+                {
+                    try { run_chunk(c, offsets[c], measureOnly); }
+                    catch (const std::exception&) { malformed = true; }
+                });
             }
-            _is >> skip_ascii_buffer;
-            return f.prop_stride;
+            for (auto& w : workers) w.join();
         };
-    }
 
-    auto element_property_lookup = make_property_lookup_table();
+        // chunkOffsets[c][g]: where chunk c starts writing group g
+        std::vector<std::vector<size_t>> chunkOffsets(numChunks, std::vector<size_t>(groups.size(), 0));
+        std::vector<size_t> groupTotals(groups.size(), 0);
 
-    size_t element_idx = 0;
-    size_t property_index = 0;
-    for (auto& element : elements)
-    {
-        for (size_t count = 0; count < element.size; ++count)
+        const bool anyList = std::find(hasList.begin(), hasList.end(), true) != hasList.end();
+        std::vector<std::vector<size_t>> chunkBytes(numChunks, std::vector<size_t>(groups.size(), 0));
+        if (anyList)
+        {
+            run_parallel(chunkBytes, true);
+            if (malformed) return give_up();
+        }
+
+        // The whole element is written contiguously, so make room for it in each group's arena first
+        for (size_t g = 0; g < groups.size(); ++g)
         {
-            property_index = 0;
-            for (auto& property : element.properties)
+            for (size_t c = 0; c < numChunks; ++c)
+                groupTotals[g] += hasList[g] ? chunkBytes[c][g] : (chunkFirstRecord[c + 1] - chunkFirstRecord[c]) * fixedBytes[g];
+            reserve_bytes(*groups[g], groupTotals[g]);
+
+            size_t offset = groups[g]->cursor->byteOffset;
+            for (size_t c = 0; c < numChunks; ++c)
             {
-                auto& f = element_property_lookup[element_idx][property_index];
-                if (!f.skip)
-                {
-                    auto* helper = f.helper;
-                    if (firstPass) helper->cursor->totalSizeBytes += skip(f, property, is);
-                    else read(f, property, helper->data->buffer.get(), helper->cursor->byteOffset, is);
-                }
-                else skip(f, property, is);
-                property_index++;
+                chunkOffsets[c][g] = offset;
+                offset += hasList[g] ? chunkBytes[c][g] : (chunkFirstRecord[c + 1] - chunkFirstRecord[c]) * fixedBytes[g];
             }
         }
-        element_idx++;
+
+        run_parallel(chunkOffsets, false);
+        if (malformed) return give_up();
+
+        for (size_t g = 0; g < groups.size(); ++g)
+        {
+            groups[g]->cursor->byteOffset += groupTotals[g];
+            if (groups[g]->triangulate) groups[g]->cursor->numPolygons += element.size;
+        }
+        element_decoded(element_idx - 1, since);
     }
 
-    // Reset istream reader to the beginning
-    if (firstPass) is.seekg(start, is.beg);
+    return true;
 }
 
 // Wrap the public interface:
@@ -881,16 +3882,52 @@ void PlyFile::PlyFileImpl::parse_data(std::istream& is, bool firstPass)
 PlyFile::PlyFile() { impl.reset(new PlyFileImpl()); }
 PlyFile::~PlyFile() { }
 bool PlyFile::parse_header(std::istream& is) { return impl->parse_header(is); }
-void PlyFile::read(std::istream& is) { return impl->read(is); }
+void PlyFile::read(std::istream& is, const PlyReadOptions& options) { impl->options = options; impl->reset_read_stats(); return impl->read(is); }
+void PlyFile::read_mapped(const std::string& path, const PlyReadOptions& options) { impl->options = options; impl->reset_read_stats(); return impl->read_mapped(path); }
+std::future<void> PlyFile::read_async(const std::string& path, const PlyReadOptions& options) { impl->options = options; impl->reset_read_stats(); return impl->read_async(path); }
 void PlyFile::write(std::ostream& os, bool isBinary) { return impl->write(os, isBinary); }
 std::vector<PlyElement> PlyFile::get_elements() const { return impl->elements; }
+PlyIndex PlyFile::index() const { return impl->index(); }
+bool PlyFile::parse_header(std::istream& is, const PlySchema& schema) { return schema.state && impl->parse_header(is, *schema.state); }
+std::vector<std::shared_ptr<PlyData>> PlyFile::get_requests() const { return impl->requestedData; }
+const PlyReadStats& PlyFile::get_read_stats() const { return impl->stats; }
+
+std::shared_ptr<PlyData> PlyFile::read_range(const std::string& path, const std::string& elementKey,
+    const std::initializer_list<std::string> propertyKeys, const size_t first, const size_t count, const Type type)
+{
+    return impl->read_range(path, elementKey, propertyKeys, first, count, type);
+}
 std::vector<std::string>& PlyFile::get_comments() { return impl->comments; }
 std::vector<std::string> PlyFile::get_info() const { return impl->objInfo; }
 std::shared_ptr<PlyData> PlyFile::request_properties_from_element(const std::string& elementKey,
     const std::initializer_list<std::string> propertyKeys,
-    const uint32_t list_size_hint)
+    const uint32_t list_size_hint, const Type type, const Layout layout)
+{
+    return impl->request_properties_from_element(elementKey, propertyKeys, list_size_hint, type, layout);
+}
+PlyTriangulatedFaces PlyFile::request_triangulated_faces(const std::string& elementKey,
+    const std::string& propertyKey, const bool polygon_offsets)
+{
+    return impl->request_triangulated_faces(elementKey, propertyKey, polygon_offsets);
+}
+
+PlyGaussianSplats PlyFile::request_gaussian_splats(const std::string& elementKey, const bool activate)
+{
+    return impl->request_gaussian_splats(elementKey, activate);
+}
+
+void PlyFile::request_batches(const std::string& elementKey, const std::initializer_list<std::string> propertyKeys,
+    const size_t batch_size, std::function<void(const PlyData& batch, size_t first)> callback,
+    const uint32_t list_size_hint, const Type type)
 {
-    return impl->request_properties_from_element(elementKey, propertyKeys, list_size_hint);
+    impl->request_batches(elementKey, propertyKeys, batch_size, callback, list_size_hint, type);
+}
+
+void PlyFile::request_struct(const std::string& elementKey, const std::initializer_list<std::string> propertyKeys,
+    const Type* types, const size_t* offsets, const size_t numFields, const size_t stride,
+    std::shared_ptr<void> storage, uint8_t* (*resize)(void* storage, size_t count))
+{
+    impl->request_struct(elementKey, propertyKeys, types, offsets, numFields, stride, storage, resize);
 }
 void PlyFile::add_properties_to_element(const std::string& elementKey,
     const std::initializer_list<std::string> propertyKeys,
@@ -899,4 +3936,122 @@ void PlyFile::add_properties_to_element(const std::string& elementKey,
     return impl->add_properties_to_element(elementKey, propertyKeys, type, count, data, listType, listCount);
 }
 
+struct PlyBufferPool::State
+{
+    std::mutex mutex;
+    std::multimap<size_t, uint8_t*> cached; // released blocks by size
+    PlyBufferPoolStats stats;
+    size_t maxCachedBytes;
+    size_t granularity;
+
+    ~State() { for (auto& block : cached) delete[] block.second; }
+
+    // Runs when the last buffer using |block| dies
+    void release(uint8_t* block, const size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.releases++;
+        if (stats.bytes_cached + bytes > maxCachedBytes) { delete[] block; return; }
+        cached.emplace(bytes, block);
+        stats.bytes_cached += bytes;
+    }
+};
+
+PlyBufferPool::PlyBufferPool(const size_t max_cached_bytes, const size_t granularity) : state(std::make_shared<State>())
+{
+    state->maxCachedBytes = max_cached_bytes;
+    state->granularity = std::max<size_t>(granularity, 1);
+}
+
+Buffer PlyBufferPool::allocate(const size_t bytes)
+{
+    const size_t rounded = std::max<size_t>(1, (bytes + state->granularity - 1) / state->granularity) * state->granularity;
+
+    uint8_t* block = nullptr;
+    size_t blockBytes = rounded;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        auto it = state->cached.lower_bound(rounded);
+        if (it != state->cached.end() && it->first <= 2 * rounded)
+        {
+            block = it->second;
+            blockBytes = it->first;
+            state->cached.erase(it);
+            state->stats.bytes_cached -= blockBytes;
+            state->stats.reuses++;
+        }
+        else
+        {
+            state->stats.heap_allocations++;
+            state->stats.bytes_allocated += rounded;
+        }
+    }
+    if (!block) block = new uint8_t[rounded];
+
+    std::shared_ptr<State> pool = state;
+    std::shared_ptr<uint8_t> owner(block, [pool, blockBytes](uint8_t* p) { pool->release(p, blockBytes); });
+    return Buffer(block, bytes, owner);
+}
+
+PlyBufferPoolStats PlyBufferPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->stats;
+}
+
+void PlyBufferPool::trim()
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    for (auto& block : state->cached) delete[] block.second;
+    state->cached.clear();
+    state->stats.bytes_cached = 0;
+}
+
+void tinyply::read_ply_files(const std::vector<std::string>& paths, std::function<void(size_t index, PlyFile& file)> request,
+    const unsigned int num_threads, const PlyReadOptions& options)
+{
+    const size_t numThreads = std::min<size_t>(paths.size(), num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency()));
+
+    std::atomic<size_t> next{ 0 };
+    std::mutex errorMutex;
+    size_t errorIndex = paths.size();
+    std::string errorMessage;
+
+    auto worker = [&]()
+    {
+        // Reused from one file to the next, so a sequence of similar frames allocates it once
+        std::vector<uint8_t> contents;
+        for (size_t i = next++; i < paths.size(); i = next++)
+        {
+            try
+            {
+                {
+                    PlyRandomAccessFile input(paths[i]);
+                    contents.resize(size_t(input.size()));
+                    input.read(contents.data(), contents.size(), 0);
+                }
+
+                memory_streambuf buffer(contents.data(), contents.size());
+                std::istream is(&buffer);
+                PlyFile file;
+                if (!file.parse_header(is)) throw std::runtime_error("could not parse header");
+                request(i, file);
+                file.read(is, options);
+            }
+            catch (const std::exception& e)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (i < errorIndex) { errorIndex = i; errorMessage = e.what(); }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < numThreads; ++t) workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers) w.join();
+
+    if (errorIndex < paths.size()) throw std::runtime_error(paths[errorIndex] + ": " + errorMessage);
+}
+
 #endif // end TINYPLY_IMPLEMENTATION
\ No newline at end of file
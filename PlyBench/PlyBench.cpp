@@ -0,0 +1,579 @@
+// Microbenchmarks for the tinyply decoders. Compiles the implementation directly so the
+// internal conversion routines can be timed in isolation.
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+#define TINYPLY_IMPLEMENTATION
+#include "../PlyAnal/tinyply.h"
+using namespace tinyply;
+
+class manual_timer
+{
+    std::chrono::high_resolution_clock::time_point t0;
+    double timestamp{ 0.f };
+public:
+    void start() { t0 = std::chrono::high_resolution_clock::now(); }
+    void stop() { timestamp = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - t0).count() * 1000; }
+    const double& get() { return timestamp; }
+};
+
+// Coordinates formatted the way common exporters write them
+std::vector<std::string> make_float_strings(const size_t count, const int style)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> coord(-250.0, 250.0);
+    std::vector<std::string> values(count);
+    char text[64];
+    for (auto & v : values)
+    {
+        const double x = coord(rng);
+        switch (style)
+        {
+        case 0: std::snprintf(text, sizeof(text), "%.6f", x); break;        // MeshLab / Blender
+        case 1: std::snprintf(text, sizeof(text), "%g", x); break;          // C++ iostream default
+        case 2: std::snprintf(text, sizeof(text), "%.9g", float(x)); break; // float round trip
+        case 3: std::snprintf(text, sizeof(text), "%.17g", x); break;       // double round trip
+        default: std::snprintf(text, sizeof(text), "%e", x); break;          // scientific
+        }
+        v = text;
+    }
+    return values;
+}
+
+template<typename T> T strto(const char* s);
+template<> float strto<float>(const char* s) { return std::strtof(s, nullptr); }
+template<> double strto<double>(const char* s) { return std::strtod(s, nullptr); }
+
+template<typename T> void benchmark_float_parsing(const char* label, const std::vector<std::string>& values)
+{
+    std::string joined;
+    for (auto & v : values) { joined += v; joined += ' '; }
+
+    std::vector<T> viaStream(values.size()), viaLibc(values.size()), viaFast(values.size());
+    manual_timer timer;
+    const double mb = joined.size() / (1024.0 * 1024.0);
+
+    std::istringstream is(joined);
+    timer.start();
+    for (auto & v : viaStream) v = ply_read_ascii<T>(is);
+    timer.stop();
+    const double streamMs = timer.get();
+
+    timer.start();
+    for (size_t i = 0; i < values.size(); ++i) viaLibc[i] = strto<T>(values[i].c_str());
+    timer.stop();
+    const double libcMs = timer.get();
+
+    timer.start();
+    for (size_t i = 0; i < values.size(); ++i) viaFast[i] = ply_parse_float<T>(values[i].data(), values[i].data() + values[i].size());
+    timer.stop();
+    const double fastMs = timer.get();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (std::memcmp(&viaLibc[i], &viaFast[i], sizeof(T)) || std::memcmp(&viaStream[i], &viaFast[i], sizeof(T))) ++mismatches;
+    }
+
+    const double n = double(values.size());
+    std::printf("%-28s stream %6.1f ns (%6.1f MB/s)  strto %6.1f ns (%6.1f MB/s)  fast %6.1f ns (%6.1f MB/s)  mismatches %zu\n",
+        label,
+        streamMs * 1e6 / n, mb / (streamMs / 1000.0),
+        libcMs * 1e6 / n, mb / (libcMs / 1000.0),
+        fastMs * 1e6 / n, mb / (fastMs / 1000.0),
+        mismatches);
+}
+
+// A binary frame of a volumetric sequence: a grid of vertices with normals, triangulated
+std::string make_frame(const size_t numVertices)
+{
+    const size_t side = std::max<size_t>(2, size_t(std::sqrt(double(numVertices))));
+    std::vector<float> vertices;
+    for (size_t y = 0; y < side; ++y)
+    {
+        for (size_t x = 0; x < side; ++x)
+        {
+            const float v[6] = { float(x), float(y), std::sin(x * 0.1f) * std::cos(y * 0.1f), 0.f, 0.f, 1.f };
+            vertices.insert(vertices.end(), v, v + 6);
+        }
+    }
+
+    std::vector<uint32_t> faces;
+    for (uint32_t y = 0; y + 1 < side; ++y)
+    {
+        for (uint32_t x = 0; x + 1 < side; ++x)
+        {
+            const uint32_t i = uint32_t(y * side + x);
+            const uint32_t quad[6] = { i, i + 1, uint32_t(i + side), i + 1, uint32_t(i + side + 1), uint32_t(i + side) };
+            faces.insert(faces.end(), quad, quad + 6);
+        }
+    }
+
+    PlyFile file;
+    file.add_properties_to_element("vertex", { "x", "y", "z", "nx", "ny", "nz" }, Type::FLOAT32, side * side, reinterpret_cast<uint8_t*>(vertices.data()), Type::INVALID, 0);
+    file.add_properties_to_element("face", { "vertex_indices" }, Type::UINT32, faces.size() / 3, reinterpret_cast<uint8_t*>(faces.data()), Type::UINT8, 3);
+    std::ostringstream os;
+    file.write(os, true);
+    return os.str();
+}
+
+// Writes |numFrames| frames into |directory| (which must exist), then loads them one file at a time
+// with std::ifstream and with `read_ply_files`. The frames were just written, so both runs read
+// from the page cache; they compare per-file overhead and decoding, not the disk.
+void benchmark_frames(const std::string& directory, const size_t numFrames, const size_t numVertices)
+{
+    const std::string frame = make_frame(numVertices);
+    std::vector<std::string> paths(numFrames);
+    char name[32];
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        std::snprintf(name, sizeof(name), "/frame_%05zu.ply", i);
+        paths[i] = directory + name;
+        std::ofstream out(paths[i], std::ios::binary);
+        out.write(frame.data(), std::streamsize(frame.size()));
+        if (!out) throw std::runtime_error("failed to write " + paths[i]);
+    }
+
+    const double mb = double(frame.size()) * numFrames / (1024.0 * 1024.0);
+    std::printf("%zu frames of %.2f MB (%.1f MB total)\n", numFrames, frame.size() / (1024.0 * 1024.0), mb);
+
+    auto report = [&](const char* label, const double ms, const size_t faces)
+    {
+        std::printf("%-24s %8.1f ms  %8.1f files/s  %8.1f MB/s  (%zu faces)\n", label, ms, numFrames / (ms / 1000.0), mb / (ms / 1000.0), faces);
+    };
+
+    // Faces hold lists, so only the vertices take the bulk binary path
+    manual_timer timer;
+    for (const bool bulk : { true, false })
+    {
+        PlyReadOptions options;
+        options.bulk_binary = bulk;
+        size_t serialFaces = 0;
+        timer.start();
+        for (const auto& path : paths)
+        {
+            std::ifstream is(path, std::ios::binary);
+            PlyFile file;
+            file.parse_header(is);
+            auto vertices = file.request_properties_from_element("vertex", { "x", "y", "z", "nx", "ny", "nz" });
+            auto faces = file.request_properties_from_element("face", { "vertex_indices" }, 3);
+            file.read(is, options);
+            serialFaces += faces->count;
+        }
+        timer.stop();
+        report(bulk ? "ifstream, serial" : "ifstream, serial, no bulk", timer.get(), serialFaces);
+    }
+
+    std::vector<std::shared_ptr<PlyData>> faces(numFrames);
+    timer.start();
+    read_ply_files(paths, [&](size_t i, PlyFile& file)
+    {
+        file.request_properties_from_element("vertex", { "x", "y", "z", "nx", "ny", "nz" });
+        faces[i] = file.request_properties_from_element("face", { "vertex_indices" }, 3);
+    });
+    timer.stop();
+    size_t batchFaces = 0;
+    for (auto& f : faces) batchFaces += f->count;
+    report("read_ply_files", timer.get(), batchFaces);
+    faces.clear();
+
+    // Playback keeps one frame alive at a time; with a pool, its storage is reused by the next one,
+    // and with a schema the header of every frame after the first is only compared, not parsed
+    auto pool = std::make_shared<PlyBufferPool>();
+    const char* playbacks[] = { "playback, new[]", "playback, pooled", "playback, pooled+schema" };
+    for (int variant = 0; variant < 3; ++variant)
+    {
+        PlyReadOptions options;
+        if (variant > 0) options.allocator = pool;
+        PlySchema schema;
+        std::vector<std::shared_ptr<PlyData>> current;
+        size_t playbackFaces = 0;
+        timer.start();
+        for (const auto& path : paths)
+        {
+            std::ifstream is(path, std::ios::binary);
+            PlyFile file;
+            if (!file.parse_header(is, schema))
+            {
+                file.parse_header(is);
+                file.request_properties_from_element("vertex", { "x", "y", "z", "nx", "ny", "nz" });
+                file.request_properties_from_element("face", { "vertex_indices" }, 3);
+                if (variant == 2) schema = PlySchema(file);
+            }
+            file.read(is, options);
+            current = file.get_requests();
+            playbackFaces += current[1]->count;
+        }
+        timer.stop();
+        report(playbacks[variant], timer.get(), playbackFaces);
+    }
+    const PlyBufferPoolStats stats = pool->stats();
+    std::printf("pool: %zu heap allocations (%.1f MB), %zu reuses\n", stats.heap_allocations, stats.bytes_allocated / (1024.0 * 1024.0), stats.reuses);
+}
+
+// A cube tessellated into |side| x |side| quads per face, the large scale counterpart of
+// `make_cube_geometry` in PlyAnal: x y z nx ny nz u v per vertex, four indices per quad
+struct synthetic_mesh
+{
+    size_t numVertices{ 0 };
+    std::vector<float> vertices;
+    std::vector<uint32_t> quads;
+};
+
+synthetic_mesh make_tessellated_cube(const size_t targetVertices)
+{
+    const size_t side = std::max<size_t>(1, size_t(std::sqrt(targetVertices / 6.0)) - 1);
+    const float axes[6][3][3] = { // normal, u direction, v direction
+        { { -1, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 } }, { { +1, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 } },
+        { { 0, -1, 0 }, { 1, 0, 0 }, { 0, 0, 1 } }, { { 0, +1, 0 }, { -1, 0, 0 }, { 0, 0, 1 } },
+        { { 0, 0, -1 }, { 0, 1, 0 }, { 1, 0, 0 } }, { { 0, 0, +1 }, { 1, 0, 0 }, { 0, 1, 0 } } };
+
+    synthetic_mesh mesh;
+    for (uint32_t f = 0; f < 6; ++f)
+    {
+        const uint32_t base = uint32_t(mesh.numVertices);
+        const float* n = axes[f][0];
+        const float* du = axes[f][1];
+        const float* dv = axes[f][2];
+        for (size_t j = 0; j <= side; ++j)
+        {
+            for (size_t i = 0; i <= side; ++i)
+            {
+                const float u = float(i) / side, v = float(j) / side;
+                for (int k = 0; k < 3; ++k) mesh.vertices.push_back(n[k] + (2 * u - 1) * du[k] + (2 * v - 1) * dv[k]);
+                mesh.vertices.insert(mesh.vertices.end(), { n[0], n[1], n[2], u, v });
+                ++mesh.numVertices;
+            }
+        }
+        for (uint32_t j = 0; j < side; ++j)
+        {
+            for (uint32_t i = 0; i < side; ++i)
+            {
+                const uint32_t q = base + j * uint32_t(side + 1) + i;
+                mesh.quads.insert(mesh.quads.end(), { q, q + 1, q + uint32_t(side) + 2, q + uint32_t(side) + 1 });
+            }
+        }
+    }
+    return mesh;
+}
+
+enum class synthetic_schema { triangles, quads, wide };
+
+// Writes |mesh| as ascii or binary (little or big endian). Triangles and quads share the mesh
+// vertices; wide files have the 62 float properties per vertex of a Gaussian splat capture
+// (positions, normals and 3rd degree SH, opacity, scales, rotations) and no faces.
+void write_synthetic_ply(const std::string& path, const synthetic_mesh& mesh, const synthetic_schema schema, const bool binary, const bool bigEndian)
+{
+    std::vector<std::string> names;
+    if (schema == synthetic_schema::wide)
+    {
+        names = { "x", "y", "z", "nx", "ny", "nz", "f_dc_0", "f_dc_1", "f_dc_2" };
+        for (int i = 0; i < 45; ++i) names.push_back("f_rest_" + std::to_string(i));
+        names.insert(names.end(), { "opacity", "scale_0", "scale_1", "scale_2", "rot_0", "rot_1", "rot_2", "rot_3" });
+    }
+    else names = { "x", "y", "z", "nx", "ny", "nz", "u", "v" };
+
+    std::ofstream out(path, std::ios::binary);
+    out << "ply\nformat " << (!binary ? "ascii" : bigEndian ? "binary_big_endian" : "binary_little_endian") << " 1.0\n";
+    out << "comment synthetic benchmark file\n";
+    out << "element vertex " << mesh.numVertices << "\n";
+    for (auto& name : names) out << "property float " << name << "\n";
+    const size_t numFaces = mesh.quads.size() / 4;
+    if (schema == synthetic_schema::triangles) out << "element face " << numFaces * 2 << "\nproperty list uchar uint vertex_indices\n";
+    if (schema == synthetic_schema::quads) out << "element face " << numFaces << "\nproperty list uchar uint vertex_indices\n";
+    out << "end_header\n";
+
+    std::string payload;
+    char text[32];
+    auto put = [&](const void* value, const size_t bytes, const bool isFloat)
+    {
+        if (!binary)
+        {
+            if (isFloat) std::snprintf(text, sizeof(text), "%g ", *static_cast<const float*>(value));
+            else if (bytes == 1) std::snprintf(text, sizeof(text), "%u ", unsigned(*static_cast<const uint8_t*>(value)));
+            else std::snprintf(text, sizeof(text), "%u ", *static_cast<const uint32_t*>(value));
+            payload += text;
+            return;
+        }
+        const char* b = static_cast<const char*>(value);
+        for (size_t i = 0; i < bytes; ++i) payload += b[bigEndian ? bytes - 1 - i : i];
+    };
+    auto end_record = [&]()
+    {
+        if (!binary) payload.back() = '\n';
+        if (payload.size() > (1 << 20)) { out.write(payload.data(), std::streamsize(payload.size())); payload.clear(); }
+    };
+
+    for (size_t i = 0; i < mesh.numVertices; ++i)
+    {
+        const float* v = &mesh.vertices[i * 8];
+        for (size_t k = 0; k < names.size(); ++k)
+        {
+            const float value = (k < 6 || schema != synthetic_schema::wide) ? v[k] : std::sin(v[0] * (k + 1) + v[1] * 0.5f + v[2]) * 0.5f;
+            put(&value, 4, true);
+        }
+        end_record();
+    }
+    for (size_t f = 0; f < numFaces && schema != synthetic_schema::wide; ++f)
+    {
+        const uint32_t* q = &mesh.quads[f * 4];
+        const uint32_t triangles[2][3] = { { q[0], q[1], q[2] }, { q[0], q[2], q[3] } };
+        const uint8_t count = schema == synthetic_schema::quads ? 4 : 3;
+        for (int t = 0; t < (schema == synthetic_schema::quads ? 1 : 2); ++t)
+        {
+            put(&count, 1, false);
+            for (int k = 0; k < count; ++k) put(schema == synthetic_schema::quads ? &q[k] : &triangles[t][k], 4, false);
+            end_record();
+        }
+    }
+    out.write(payload.data(), std::streamsize(payload.size()));
+    if (!out) throw std::runtime_error("failed to write " + path);
+}
+
+struct suite_case
+{
+    const char* name;
+    const char* file;
+    std::function<void(PlyFile&)> request;
+};
+
+struct suite_result
+{
+    std::string name, method;
+    size_t bytes{ 0 }, records{ 0 }, runs{ 0 };
+    double headerMs{ 0 }, readMs{ 0 }, readMinMs{ 0 }, totalMs{ 0 };
+    double mapMs{ 0 }, allocateMs{ 0 }, decodeMs{ 0 }, finishMs{ 0 }; // medians of `PlyReadStats`
+    size_t readCalls{ 0 }, allocations{ 0 }, bytesSkipped{ 0 };
+};
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// Generates the synthetic files into |directory| (which must exist) and loads each case |runs|
+// times through a stream and through a mapping of the file, and binary cases once more each way
+// with `bulk_binary` off. The files were just written, so the
+// runs read from the page cache. Reports the median time of each phase as csv or json on stdout.
+void benchmark_suite(const std::string& directory, const size_t numVertices, const size_t runs, const bool json)
+{
+    const synthetic_mesh mesh = make_tessellated_cube(numVertices);
+    const struct { const char* file; synthetic_schema schema; bool binary, bigEndian; } files[] = {
+        { "suite_ascii.ply", synthetic_schema::triangles, false, false },
+        { "suite_le.ply", synthetic_schema::triangles, true, false },
+        { "suite_be.ply", synthetic_schema::triangles, true, true },
+        { "suite_quads_le.ply", synthetic_schema::quads, true, false },
+        { "suite_wide_le.ply", synthetic_schema::wide, true, false } };
+    for (auto& f : files)
+    {
+        std::fprintf(stderr, "writing %s\n", f.file);
+        write_synthetic_ply(directory + "/" + f.file, mesh, f.schema, f.binary, f.bigEndian);
+    }
+
+    auto mesh_request = [](PlyFile& file)
+    {
+        file.request_properties_from_element("vertex", { "x", "y", "z", "nx", "ny", "nz", "u", "v" });
+        file.request_properties_from_element("face", { "vertex_indices" }, 3);
+    };
+    auto vertex_request = [](PlyFile& file) { file.request_properties_from_element("vertex", { "x", "y", "z" }); };
+    const suite_case cases[] = {
+        { "ascii", "suite_ascii.ply", mesh_request },
+        { "binary_le", "suite_le.ply", mesh_request },
+        { "binary_be", "suite_be.ply", mesh_request },
+        { "quads_hint", "suite_quads_le.ply", [](PlyFile& file) { file.request_properties_from_element("face", { "vertex_indices" }, 4); } },
+        { "quads_no_hint", "suite_quads_le.ply", [](PlyFile& file) { file.request_properties_from_element("face", { "vertex_indices" }); } },
+        { "wide_all", "suite_wide_le.ply", [](PlyFile& file) { file.request_gaussian_splats(); } },
+        { "wide_xyz", "suite_wide_le.ply", vertex_request },
+        { "ascii_unrequested_faces", "suite_ascii.ply", vertex_request },
+        { "binary_le_unrequested_faces", "suite_le.ply", vertex_request } };
+
+    const struct { const char* name; bool mapped, bulk; } methods[] = {
+        { "stream", false, true }, { "mapped", true, true }, { "stream_no_bulk", false, false }, { "mapped_no_bulk", true, false } };
+
+    std::vector<suite_result> results;
+    for (auto& c : cases)
+    {
+        const std::string path = directory + "/" + c.file;
+        const bool binary = std::find_if(std::begin(files), std::end(files), [&](decltype(files[0]) f) { return std::strcmp(f.file, c.file) == 0; })->binary;
+        for (auto& method : methods)
+        {
+            if (!method.bulk && !binary) continue;
+            const bool mapped = method.mapped;
+            PlyReadOptions options;
+            options.bulk_binary = method.bulk;
+            suite_result result;
+            result.name = c.name;
+            result.method = method.name;
+            result.runs = runs;
+            std::vector<double> header, read, total, map, allocate, decode, finish;
+            manual_timer timer;
+            for (size_t r = 0; r < runs; ++r)
+            {
+                const auto t0 = std::chrono::high_resolution_clock::now();
+                std::ifstream is(path, std::ios::binary);
+                PlyFile file;
+                timer.start();
+                file.parse_header(is);
+                c.request(file);
+                timer.stop();
+                header.push_back(timer.get());
+
+                timer.start();
+                if (mapped) file.read_mapped(path, options);
+                else file.read(is, options);
+                timer.stop();
+                read.push_back(timer.get());
+                total.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count());
+
+                const PlyReadStats& stats = file.get_read_stats();
+                map.push_back(stats.map_ms);
+                allocate.push_back(stats.allocate_ms);
+                decode.push_back(stats.decode_ms);
+                finish.push_back(stats.finish_ms);
+                if (r == 0)
+                {
+                    result.readCalls = stats.read_calls;
+                    result.allocations = stats.allocations;
+                    result.bytesSkipped = stats.bytes_skipped;
+                    is.clear();
+                    is.seekg(0, std::ios::end);
+                    result.bytes = size_t(is.tellg());
+                    for (auto& e : file.get_elements()) result.records += e.size;
+                }
+            }
+            result.headerMs = median(header);
+            result.readMs = median(read);
+            result.readMinMs = *std::min_element(read.begin(), read.end());
+            result.totalMs = median(total);
+            result.mapMs = median(map);
+            result.allocateMs = median(allocate);
+            result.decodeMs = median(decode);
+            result.finishMs = median(finish);
+            results.push_back(result);
+            std::fprintf(stderr, "%-28s %-14s %9.2f ms\n", c.name, result.method.c_str(), result.totalMs);
+        }
+    }
+
+    if (json) std::printf("[\n");
+    else std::printf("case,method,bytes,records,runs,header_ms,read_ms,read_min_ms,total_ms,mb_per_s,records_per_s,"
+        "map_ms,allocate_ms,decode_ms,finish_ms,read_calls,allocations,bytes_skipped\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const suite_result& r = results[i];
+        const double mbPerSecond = r.bytes / (1024.0 * 1024.0) / (r.totalMs / 1000.0);
+        const double recordsPerSecond = r.records / (r.totalMs / 1000.0);
+        if (json)
+        {
+            std::printf("  { \"case\": \"%s\", \"method\": \"%s\", \"bytes\": %zu, \"records\": %zu, \"runs\": %zu, "
+                "\"header_ms\": %.3f, \"read_ms\": %.3f, \"read_min_ms\": %.3f, \"total_ms\": %.3f, \"mb_per_s\": %.1f, \"records_per_s\": %.0f, "
+                "\"map_ms\": %.3f, \"allocate_ms\": %.3f, \"decode_ms\": %.3f, \"finish_ms\": %.3f, \"read_calls\": %zu, \"allocations\": %zu, \"bytes_skipped\": %zu }%s\n",
+                r.name.c_str(), r.method.c_str(), r.bytes, r.records, r.runs, r.headerMs, r.readMs, r.readMinMs, r.totalMs,
+                mbPerSecond, recordsPerSecond, r.mapMs, r.allocateMs, r.decodeMs, r.finishMs, r.readCalls, r.allocations, r.bytesSkipped,
+                i + 1 < results.size() ? "," : "");
+        }
+        else
+        {
+            std::printf("%s,%s,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.1f,%.0f,%.3f,%.3f,%.3f,%.3f,%zu,%zu,%zu\n", r.name.c_str(), r.method.c_str(), r.bytes, r.records, r.runs,
+                r.headerMs, r.readMs, r.readMinMs, r.totalMs, mbPerSecond, recordsPerSecond,
+                r.mapMs, r.allocateMs, r.decodeMs, r.finishMs, r.readCalls, r.allocations, r.bytesSkipped);
+        }
+    }
+    if (json) std::printf("]\n");
+}
+
+// Loads an ascii file with triangulated faces followed by an element the parallel decoder can't
+// split (its first record wraps onto a second line), so it falls back to the serial decoder after
+// the faces were already decoded. Compares the result with a serial load; returns the mismatches.
+size_t check_ascii_fallback(const std::string& directory)
+{
+    const std::string path = directory + "/check_ascii_fallback.ply";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "ply\nformat ascii 1.0\nelement vertex 5\nproperty float x\nproperty float y\nproperty float z\n"
+            "element face 3\nproperty list uchar uint vertex_indices\nelement edge 2\nproperty int vertex1\nproperty int vertex2\nend_header\n"
+            "0 0 0\n1 0 0\n1 1 0\n0 1 0\n2 2 0\n"
+            "4 0 1 2 3\n3 1 4 2\n5 0 1 4 2 3\n"
+            "0\n1\n2 3\n";
+        if (!out) throw std::runtime_error("failed to write " + path);
+    }
+
+    struct loaded { PlyTriangulatedFaces faces; std::shared_ptr<PlyData> edges; };
+    auto load = [&](const unsigned int numThreads)
+    {
+        PlyFile file;
+        std::ifstream is(path, std::ios::binary);
+        file.parse_header(is);
+        loaded result;
+        result.faces = file.request_triangulated_faces("face", "vertex_indices", true);
+        result.edges = file.request_properties_from_element("edge", { "vertex1", "vertex2" });
+        PlyReadOptions options;
+        options.num_threads = numThreads;
+        file.read_mapped(path, options);
+        return result;
+    };
+
+    auto differs = [](const PlyData& a, const PlyData& b, const size_t valuesPerRecord)
+    {
+        return a.count != b.count || std::memcmp(a.buffer.get(), b.buffer.get(), a.count * valuesPerRecord * sizeof(uint32_t)) != 0;
+    };
+
+    const loaded serial = load(1), parallel = load(4);
+    size_t mismatches = 0;
+    if (differs(*serial.faces.triangles, *parallel.faces.triangles, 3)) ++mismatches;
+    if (differs(*serial.faces.polygon_offsets, *parallel.faces.polygon_offsets, 1)) ++mismatches;
+    if (differs(*serial.edges, *parallel.edges, 2)) ++mismatches;
+    std::printf("%-28s mismatches %zu\n", "ascii parallel fallback", mismatches);
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    // PlyBench check <directory>
+    if (argc > 2 && std::string(argv[1]) == "check")
+        return check_ascii_fallback(argv[2]) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    // PlyBench suite <directory> [vertices] [runs] [csv|json]
+    if (argc > 2 && std::string(argv[1]) == "suite")
+    {
+        const size_t numVertices = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 1000000;
+        const size_t runs = (argc > 4) ? std::max<size_t>(1, std::strtoul(argv[4], nullptr, 10)) : 5;
+        const bool json = (argc > 5) && std::string(argv[5]) == "json";
+        benchmark_suite(argv[2], numVertices, runs, json);
+        return EXIT_SUCCESS;
+    }
+
+    // PlyBench frames <directory> [frames] [vertices per frame]
+    if (argc > 2 && std::string(argv[1]) == "frames")
+    {
+        const size_t numFrames = (argc > 3) ? std::strtoul(argv[3], nullptr, 10) : 5000;
+        const size_t numVertices = (argc > 4) ? std::strtoul(argv[4], nullptr, 10) : 40000;
+        benchmark_frames(argv[2], numFrames, numVertices);
+        return EXIT_SUCCESS;
+    }
+
+    const size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const char * styles[] = { "%.6f", "%g", "%.9g", "%.17g", "%e" };
+
+    std::cout << "Parsing " << count << " values per run" << std::endl;
+    for (int s = 0; s < 5; ++s)
+    {
+        const auto values = make_float_strings(count, s);
+        benchmark_float_parsing<float>((std::string("float  ") + styles[s]).c_str(), values);
+        benchmark_float_parsing<double>((std::string("double ") + styles[s]).c_str(), values);
+    }
+    return EXIT_SUCCESS;
+}